@@ -0,0 +1,203 @@
+/*
+  Measures how long OWMOneCall takes to parse a full One Call response (current, 60 minutes,
+  48 hours and 8 days) in document and streaming mode for several begin() settings, with the
+  memory and number of allocations used, and compares the size and speed of the compact
+  binary encoding with the JSON response.  The response is generated in memory so no network
+  connection or API key is needed.
+*/
+
+#include <Arduino.h>
+#include <OWMOneCall.h>
+
+OWMOneCall weather;
+
+// Number of times each parse is repeated for the average
+const uint8_t runs = 20;
+
+// Forecast counts passed to begin() for each measurement
+struct Config {
+  uint8_t minutes;
+  uint8_t hours;
+  uint8_t days;
+};
+
+const Config configs[] = {
+  {60, 48, 8},
+  {0, 48, 8},
+  {0, 12, 5},
+  {0, 0, 8},
+  {10, 0, 0},
+};
+
+// Stream that replays a response held in memory
+class ReplayStream : public Stream {
+  public:
+    ReplayStream(const String &data) : _data(data.c_str()), _len(data.length()), _pos(0) {}
+    void rewind() { _pos = 0; }
+    int available() override { return _len - _pos; }
+    int read() override { return _pos < _len ? (uint8_t)_data[_pos++] : -1; }
+    int peek() override { return _pos < _len ? (uint8_t)_data[_pos] : -1; }
+    size_t write(uint8_t) override { return 0; }
+
+  private:
+    const char *_data;
+    size_t _len;
+    size_t _pos;
+};
+
+String payload;
+
+// Function prototypes
+void buildPayload(String &json);
+uint32_t timeParse(ReplayStream &input, bool streaming);
+void measure(const Config &config, ReplayStream &input);
+void timeEncoding();
+
+void setup() {
+  Serial.begin(115200);
+
+  buildPayload(payload);
+  ReplayStream input(payload);
+
+  Serial.print(F("Response size: "));
+  Serial.print(payload.length());
+  Serial.println(F(" bytes"));
+  Serial.println(F("min hr dly  forecast B  document us  JSON B  allocs  streaming us"));
+
+  for (uint8_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) measure(configs[i], input);
+
+  weather.begin("", 1, 60, 48, 8, IMPERIAL);
+  timeParse(input, true);
+  timeEncoding();
+}
+
+void loop() {
+}
+
+uint32_t timeParse(ReplayStream &input, bool streaming) {
+  weather.setStreaming(streaming);
+
+  uint32_t start = micros();
+  for (uint8_t i = 0; i < runs; i++) {
+    input.rewind();
+    if (!weather.parseWeather(input)) Serial.println(F("Parse error"));
+  }
+  return (micros() - start) / runs;
+}
+
+// One line of the table: memory taken by the data structures, then both parse modes
+void measure(const Config &config, ReplayStream &input) {
+  weather.begin("", 0, 0, 0, 0, IMPERIAL);
+  uint32_t freeHeap = ESP.getFreeHeap();
+  weather.begin("", 1, config.minutes, config.hours, config.days, IMPERIAL);
+  uint32_t forecastSize = freeHeap - ESP.getFreeHeap();
+
+  uint32_t documentTime = timeParse(input, false);
+  size_t jsonMemory = weather.getJsonMemory();
+  uint32_t allocations = weather.getJsonAllocations();
+  uint32_t streamTime = timeParse(input, true);
+
+  char line[80];
+  snprintf(line, sizeof(line), "%3u %2u %3u  %10lu  %11lu  %6u  %6lu  %12lu", config.minutes, config.hours,
+           config.days, (unsigned long)forecastSize, (unsigned long)documentTime, (unsigned)jsonMemory,
+           (unsigned long)allocations, (unsigned long)streamTime);
+  Serial.println(line);
+}
+
+// Encode the parsed forecast and decode it into a second object set up the same way
+void timeEncoding() {
+  static OWMOneCall copy;
+  size_t size = weather.encodeForecast(NULL, 0);
+  uint8_t *buf = new uint8_t[size];
+
+  copy.begin("", 1, 60, 48, 8, IMPERIAL);
+
+  uint32_t start = micros();
+  for (uint8_t i = 0; i < runs; i++) weather.encodeForecast(buf, size);
+  uint32_t encodeTime = (micros() - start) / runs;
+
+  start = micros();
+  for (uint8_t i = 0; i < runs; i++) {
+    if (!copy.decodeForecast(buf, size)) Serial.println(F("Decode error"));
+  }
+  uint32_t decodeTime = (micros() - start) / runs;
+
+  Serial.print(F("Binary encoding: "));
+  Serial.print(size);
+  Serial.print(F(" bytes ("));
+  Serial.print(100.0 * size / payload.length(), 1);
+  Serial.print(F("% of JSON), encode "));
+  Serial.print(encodeTime);
+  Serial.print(F(" us, decode "));
+  Serial.print(decodeTime);
+  Serial.println(F(" us"));
+
+  delete [] buf;
+}
+
+// Fields shared by the current, hourly and daily sections
+void addConditions(String &json, uint16_t i) {
+  json += F("\"pressure\":1014,\"humidity\":");
+  json += 40 + i % 50;
+  json += F(",\"dew_point\":290.69,\"uvi\":");
+  json += (i % 9) * 0.75;
+  json += F(",\"clouds\":");
+  json += i % 100;
+  json += F(",\"wind_speed\":3.13,\"wind_deg\":");
+  json += (i * 37) % 360;
+  json += F(",\"wind_gust\":6.71,\"weather\":[{\"id\":500,\"main\":\"Rain\",\"description\":\"light rain\",\"icon\":\"10d\"}]");
+}
+
+void buildPayload(String &json) {
+  uint32_t now = 1684929490;
+
+  json.reserve(32768);
+  json = F("{\"lat\":39.76,\"lon\":-74.89,\"timezone\":\"America/New_York\",\"timezone_offset\":-14400,");
+
+  json += F("\"current\":{\"dt\":");
+  json += now;
+  json += F(",\"sunrise\":1684926645,\"sunset\":1684977332,\"temp\":292.55,\"feels_like\":292.87,\"visibility\":10000,");
+  addConditions(json, 0);
+  json += F(",\"rain\":{\"1h\":2.46}},");
+
+  json += F("\"minutely\":[");
+  for (uint16_t i = 0; i < 61; i++) {
+    if (i) json += ',';
+    json += F("{\"dt\":");
+    json += now + i * 60;
+    json += F(",\"precipitation\":");
+    json += (i % 7) * 0.25;
+    json += '}';
+  }
+
+  json += F("],\"hourly\":[");
+  for (uint16_t i = 0; i < 48; i++) {
+    if (i) json += ',';
+    json += F("{\"dt\":");
+    json += now + i * 3600;
+    json += F(",\"temp\":");
+    json += 280 + (i % 24) * 0.8;
+    json += F(",\"feels_like\":");
+    json += 279 + (i % 24) * 0.8;
+    json += F(",\"visibility\":10000,\"pop\":");
+    json += (i % 10) * 0.1;
+    json += ',';
+    addConditions(json, i);
+    if (i % 3 == 0) json += F(",\"rain\":{\"1h\":0.42}");
+    json += '}';
+  }
+
+  json += F("],\"daily\":[");
+  for (uint16_t i = 0; i < 8; i++) {
+    if (i) json += ',';
+    json += F("{\"dt\":");
+    json += now + i * 86400;
+    json += F(",\"sunrise\":1684926645,\"sunset\":1684977332,\"moonrise\":1684941060,\"moonset\":1684905480,"
+              "\"moon_phase\":0.16,\"summary\":\"Expect a day of partly cloudy with rain\","
+              "\"temp\":{\"day\":299.03,\"min\":290.69,\"max\":300.35,\"night\":291.45,\"eve\":297.51,\"morn\":292.55},"
+              "\"feels_like\":{\"day\":299.21,\"night\":291.37,\"eve\":297.86,\"morn\":292.87},\"pop\":0.47,\"rain\":0.15,");
+    addConditions(json, i);
+    json += '}';
+  }
+  json += F("]}");
+}
@@ -0,0 +1,58 @@
+/*
+  Times repeated getWeather() calls.  The first call has to look up the server and open the
+  connection, later calls reuse it while keep-alive is enabled.  Set keepAlive to false to
+  compare with a new connection for every call.
+*/
+
+#include <Arduino.h>
+#include <OWMOneCall.h>
+#include <WiFi.h>
+
+OWMOneCall weather;
+
+// Replace with your network information and API key
+const char* ssid = "YOUR_SSID";
+const char* password = "YOUR_PW";
+const char* API_KEY = "YOUR_API_KEY";
+
+float latitude = 39.76;
+float longitude = -74.89;
+
+const bool keepAlive = true;
+const uint8_t calls = 5;
+
+void setup() {
+  Serial.begin(115200);
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(ssid, password);
+  Serial.print(F("Connecting to WiFi .."));
+  while (WiFi.status() != WL_CONNECTED) {
+    Serial.print('.');
+    delay(1000);
+  }
+  Serial.println();
+
+  weather.begin(API_KEY, 1, 0, 12, 5, IMPERIAL);
+  weather.setLocation(latitude, longitude);
+  weather.setKeepAlive(keepAlive);
+  weather.setTimeout(3000);
+
+  for (uint8_t i = 0; i < calls; i++) {
+    uint32_t start = millis();
+    bool ok = weather.getWeather();
+    uint32_t elapsed = millis() - start;
+
+    Serial.print(F("Call "));
+    Serial.print(i + 1);
+    Serial.print(ok ? F(": ") : F(" failed: "));
+    Serial.print(elapsed);
+    Serial.println(F(" ms"));
+    delay(1000);
+  }
+
+  weather.disconnect();
+}
+
+void loop() {
+}
@@ -0,0 +1,75 @@
+/*
+  Compares the time taken by repeated getWeather() calls through the default HTTPClient
+  transport and through OWMClientTransport over a plain WiFiClient.  Both keep the connection
+  open, so after the first call the difference is the time spent sending the request and
+  reading the headers.
+*/
+
+#include <Arduino.h>
+#include <OWMOneCall.h>
+#include <WiFi.h>
+
+OWMOneCall weather;
+WiFiClient client;
+OWMClientTransport clientTransport(client);
+
+// Replace with your network information and API key
+const char* ssid = "YOUR_SSID";
+const char* password = "YOUR_PW";
+const char* API_KEY = "YOUR_API_KEY";
+
+float latitude = 39.76;
+float longitude = -74.89;
+
+const uint8_t calls = 5;
+
+void timeCalls(const __FlashStringHelper *name);
+
+void setup() {
+  Serial.begin(115200);
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(ssid, password);
+  Serial.print(F("Connecting to WiFi .."));
+  while (WiFi.status() != WL_CONNECTED) {
+    Serial.print('.');
+    delay(1000);
+  }
+  Serial.println();
+
+  weather.begin(API_KEY, 1, 0, 12, 5, IMPERIAL);
+  weather.setLocation(latitude, longitude);
+  weather.setStreaming(true);
+
+  timeCalls(F("HTTPClient"));
+
+  weather.setTransport(&clientTransport);
+  timeCalls(F("WiFiClient"));
+
+  weather.disconnect();
+}
+
+void loop() {
+}
+
+void timeCalls(const __FlashStringHelper *name) {
+  uint32_t total = 0;
+
+  Serial.println(name);
+  for (uint8_t i = 0; i < calls; i++) {
+    uint32_t start = millis();
+    bool ok = weather.getWeather();
+    uint32_t elapsed = millis() - start;
+    if (i) total += elapsed;  // The first call includes opening the connection
+
+    Serial.print(F("  Call "));
+    Serial.print(i + 1);
+    Serial.print(ok ? F(": ") : F(" failed: "));
+    Serial.print(elapsed);
+    Serial.println(F(" ms"));
+    delay(1000);
+  }
+  Serial.print(F("  Average after the first call: "));
+  Serial.print(total / (calls - 1));
+  Serial.println(F(" ms"));
+}
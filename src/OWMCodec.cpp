@@ -0,0 +1,111 @@
+/*
+  Compact binary encoding for the OWMOneCall library.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include "OWMCodec.h"
+
+OWMEncoder::OWMEncoder(uint8_t *buf, size_t size)
+  : _buf(buf), _size(buf ? size : 0), _out(NULL), _len(0), _ok(true) {}
+
+OWMEncoder::OWMEncoder(Print &out)
+  : _buf(NULL), _size(0), _out(&out), _len(0), _ok(true) {}
+
+void OWMEncoder::byte(uint8_t value) {
+  if (_out) {
+    if (_out->write(value) != 1) _ok = false;
+  } else if (_len < _size) {
+    _buf[_len] = value;
+  } else {
+    _ok = false;
+  }
+  _len++;
+}
+
+void OWMEncoder::uvar(uint32_t value) {
+  while (value >= 0x80) {
+    byte((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  byte(value);
+}
+
+void OWMEncoder::svar(int32_t value) {
+  uvar(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+void OWMEncoder::centi(float value) {
+  float scaled = value * 100;
+  if (scaled >= 2147483647.0f) scaled = 2147483647.0f;
+  else if (scaled <= -2147483648.0f) scaled = -2147483648.0f;
+  svar((int32_t)(scaled + (scaled < 0 ? -0.5f : 0.5f)));
+}
+
+void OWMEncoder::percent(float value) {
+  float scaled = value * 100 + 0.5f;
+  byte(scaled <= 0 ? 0 : (scaled >= 255 ? 255 : (uint8_t)scaled));
+}
+
+void OWMEncoder::text(const char *value) {
+  size_t len = value ? strlen(value) : 0;
+  if (len > 255) len = 255;
+
+  byte(len);
+  for (size_t i = 0; i < len; i++) byte(value[i]);
+}
+
+OWMDecoder::OWMDecoder(const uint8_t *buf, size_t size)
+  : _buf(buf), _size(size), _in(NULL), _pos(0), _ok(true) {}
+
+OWMDecoder::OWMDecoder(Stream &in)
+  : _buf(NULL), _size(0), _in(&in), _pos(0), _ok(true) {}
+
+uint8_t OWMDecoder::byte() {
+  uint8_t value = 0;
+
+  if (_in) {
+    if (_in->readBytes((char *)&value, 1) != 1) _ok = false;
+  } else if (_pos < _size) {
+    value = _buf[_pos];
+  } else {
+    _ok = false;
+  }
+  _pos++;
+  return value;
+}
+
+uint32_t OWMDecoder::uvar() {
+  uint32_t value = 0;
+
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    uint8_t b = byte();
+    value |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return value;
+  }
+  _ok = false;  // More than 5 bytes is not a 32 bit value
+  return 0;
+}
+
+int32_t OWMDecoder::svar() {
+  uint32_t value = uvar();
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+float OWMDecoder::centi() {
+  return svar() / 100.0f;
+}
+
+float OWMDecoder::percent() {
+  return byte() / 100.0f;
+}
+
+void OWMDecoder::text(char *value, size_t size) {
+  uint8_t len = byte();
+
+  for (uint8_t i = 0; i < len; i++) {
+    char c = byte();
+    if ((size_t)i + 1 < size) value[i] = c;
+  }
+  if (size) value[len < size ? len : size - 1] = 0;
+}
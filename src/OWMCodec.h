@@ -0,0 +1,72 @@
+/*
+  Compact binary encoding for the OWMOneCall library.
+
+  Forecasts are written as variable length integers: timestamps as the difference from the
+  expected step (60 s, 3600 s or 86400 s) so a regular series takes one byte per entry,
+  decimals as hundredths, percentages as one byte and the weather condition as its position
+  in the condition table.  The encoder and decoder work on a caller supplied buffer or on a
+  Print / Stream and allocate no memory.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWMCODEC_H__
+#define __OWMCODEC_H__
+
+#include <Arduino.h>
+
+// Version written at the start of every encoded forecast
+#define OWM_CODEC_VERSION 2
+
+// Writes values in the compact format.  Once the buffer is full further values are counted
+// but not written and ok() returns false, so a NULL buffer measures the size needed
+class OWMEncoder
+{
+private:
+    uint8_t *_buf;
+    size_t _size;
+    Print *_out;
+    size_t _len;
+    bool _ok;
+
+public:
+    OWMEncoder(uint8_t *buf, size_t size);
+    OWMEncoder(Print &out);
+
+    void byte(uint8_t value);
+    void uvar(uint32_t value);    // Unsigned, 7 bits per byte
+    void svar(int32_t value);     // Signed, zigzag then as uvar
+    void centi(float value);      // Hundredths as svar
+    void percent(float value);    // Fraction 0 - 1 as one byte percentage
+    void text(const char *value); // Length byte then up to 255 characters
+
+    size_t length() const { return _len; }
+    bool ok() const { return _ok; }
+};
+
+// Reads values written by OWMEncoder.  Reading past the end returns 0 and ok() false
+class OWMDecoder
+{
+private:
+    const uint8_t *_buf;
+    size_t _size;
+    Stream *_in;
+    size_t _pos;
+    bool _ok;
+
+public:
+    OWMDecoder(const uint8_t *buf, size_t size);
+    OWMDecoder(Stream &in);
+
+    uint8_t byte();
+    uint32_t uvar();
+    int32_t svar();
+    float centi();
+    float percent();
+    void text(char *value, size_t size);  // Truncated to fit size including the terminator
+
+    size_t position() const { return _pos; }
+    bool ok() const { return _ok; }
+};
+
+#endif
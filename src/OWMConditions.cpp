@@ -0,0 +1,145 @@
+/*
+  OpenWeatherMap weather condition table for the OWMOneCall library.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include "OWMConditions.h"
+
+static const char _thunderstorm[] = "Thunderstorm";
+static const char _drizzle[] = "Drizzle";
+static const char _rain[] = "Rain";
+static const char _snow[] = "Snow";
+static const char _clouds[] = "Clouds";
+static const char _dust[] = "Dust";
+
+// Sorted by ID for the binary search in owmConditionIndex()
+static const OWMCondition _conditions[] = {
+  {200, _thunderstorm, "thunderstorm with light rain"},
+  {201, _thunderstorm, "thunderstorm with rain"},
+  {202, _thunderstorm, "thunderstorm with heavy rain"},
+  {210, _thunderstorm, "light thunderstorm"},
+  {211, _thunderstorm, "thunderstorm"},
+  {212, _thunderstorm, "heavy thunderstorm"},
+  {221, _thunderstorm, "ragged thunderstorm"},
+  {230, _thunderstorm, "thunderstorm with light drizzle"},
+  {231, _thunderstorm, "thunderstorm with drizzle"},
+  {232, _thunderstorm, "thunderstorm with heavy drizzle"},
+  {300, _drizzle, "light intensity drizzle"},
+  {301, _drizzle, "drizzle"},
+  {302, _drizzle, "heavy intensity drizzle"},
+  {310, _drizzle, "light intensity drizzle rain"},
+  {311, _drizzle, "drizzle rain"},
+  {312, _drizzle, "heavy intensity drizzle rain"},
+  {313, _drizzle, "shower rain and drizzle"},
+  {314, _drizzle, "heavy shower rain and drizzle"},
+  {321, _drizzle, "shower drizzle"},
+  {500, _rain, "light rain"},
+  {501, _rain, "moderate rain"},
+  {502, _rain, "heavy intensity rain"},
+  {503, _rain, "very heavy rain"},
+  {504, _rain, "extreme rain"},
+  {511, _rain, "freezing rain"},
+  {520, _rain, "light intensity shower rain"},
+  {521, _rain, "shower rain"},
+  {522, _rain, "heavy intensity shower rain"},
+  {531, _rain, "ragged shower rain"},
+  {600, _snow, "light snow"},
+  {601, _snow, "snow"},
+  {602, _snow, "heavy snow"},
+  {611, _snow, "sleet"},
+  {612, _snow, "light shower sleet"},
+  {613, _snow, "shower sleet"},
+  {615, _snow, "light rain and snow"},
+  {616, _snow, "rain and snow"},
+  {620, _snow, "light shower snow"},
+  {621, _snow, "shower snow"},
+  {622, _snow, "heavy shower snow"},
+  {701, "Mist", "mist"},
+  {711, "Smoke", "smoke"},
+  {721, "Haze", "haze"},
+  {731, _dust, "sand/dust whirls"},
+  {741, "Fog", "fog"},
+  {751, "Sand", "sand"},
+  {761, _dust, "dust"},
+  {762, "Ash", "volcanic ash"},
+  {771, "Squall", "squalls"},
+  {781, "Tornado", "tornado"},
+  {800, "Clear", "clear sky"},
+  {801, _clouds, "few clouds"},
+  {802, _clouds, "scattered clouds"},
+  {803, _clouds, "broken clouds"},
+  {804, _clouds, "overcast clouds"},
+};
+
+static const uint8_t _conditionCount = sizeof(_conditions) / sizeof(_conditions[0]);
+
+// Interned text that is not in the table, stored back to back with terminators
+static char _pool[OWM_INTERN_POOL_SIZE];
+static uint16_t _poolUsed = 0;
+
+uint8_t owmConditionCount() {
+  return _conditionCount;
+}
+
+uint8_t owmConditionIndex(uint16_t id) {
+  uint8_t low = 0;
+  uint8_t high = _conditionCount;
+
+  while (low < high) {
+    uint8_t mid = (low + high) / 2;
+    if (_conditions[mid].id == id) return mid;
+    if (_conditions[mid].id < id) low = mid + 1;
+    else high = mid;
+  }
+  return OWM_CONDITION_UNKNOWN;
+}
+
+const OWMCondition *owmConditionAt(uint8_t index) {
+  return index < _conditionCount ? &_conditions[index] : NULL;
+}
+
+const OWMCondition *owmCondition(uint16_t id) {
+  return owmConditionAt(owmConditionIndex(id));
+}
+
+static const char *intern(const char *text) {
+  // Reuse the copy made by an earlier call
+  for (uint16_t i = 0; i < _poolUsed; i += strlen(&_pool[i]) + 1) {
+    if (!strcmp(&_pool[i], text)) return &_pool[i];
+  }
+
+  size_t len = strlen(text) + 1;
+  if (_poolUsed + len > OWM_INTERN_POOL_SIZE) return NULL;
+
+  char *copy = &_pool[_poolUsed];
+  memcpy(copy, text, len);
+  _poolUsed += len;
+  return copy;
+}
+
+// Find the permanent copy of a main (description false) or description text
+static const char *conditionText(uint16_t id, const char *text, bool description) {
+  const OWMCondition *condition = owmCondition(id);
+  const char *known = condition ? (description ? condition->description : condition->main) : "";
+
+  if (!text) return known;
+  if (!strcmp(known, text)) return known;
+
+  // The ID may not have been read yet, so look through the whole table
+  for (uint8_t i = 0; i < _conditionCount; i++) {
+    const char *entry = description ? _conditions[i].description : _conditions[i].main;
+    if (!strcmp(entry, text)) return entry;
+  }
+
+  const char *copy = intern(text);
+  return copy ? copy : known;
+}
+
+const char *owmConditionMain(uint16_t id, const char *text) {
+  return conditionText(id, text, false);
+}
+
+const char *owmConditionDescription(uint16_t id, const char *text) {
+  return conditionText(id, text, true);
+}
@@ -0,0 +1,53 @@
+/*
+  OpenWeatherMap weather condition table for the OWMOneCall library.
+    https://openweathermap.org/weather-conditions
+
+  The condition ID returned by the API determines the main group and the English description,
+  so these strings are kept in a constant table instead of being copied for every forecast.
+  Text that is not in the table is copied once into a small pool and shared from there.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWMCONDITIONS_H__
+#define __OWMCONDITIONS_H__
+
+#include <Arduino.h>
+
+// Bytes available to hold main and description text that is not in the condition table.
+// Each distinct string is stored once and never released
+#ifndef OWM_INTERN_POOL_SIZE
+#define OWM_INTERN_POOL_SIZE 256
+#endif
+
+// Index returned when a condition ID is not in the table
+#define OWM_CONDITION_UNKNOWN 0xFF
+
+// Condition ID read back from a packed record when the ID received is not in the table
+#define OWM_CONDITION_ID_UNKNOWN 0xFFFF
+
+struct OWMCondition {
+  uint16_t id;              // WeatherID
+  const char *main;         // Open Weather Main parameter
+  const char *description;  // Open Weather condition
+};
+
+// Number of conditions in the table
+uint8_t owmConditionCount();
+
+// Position of a condition ID in the table or OWM_CONDITION_UNKNOWN
+uint8_t owmConditionIndex(uint16_t id);
+
+// Condition at a position in the table, NULL when out of range
+const OWMCondition *owmConditionAt(uint8_t index);
+
+// Condition for an ID, NULL when unknown
+const OWMCondition *owmCondition(uint16_t id);
+
+// Return a permanent copy of a main or description text received for a condition ID.  The
+// table text is returned when it matches, otherwise the text is interned in the pool.  If the
+// pool is full the table text for the ID, or "", is returned instead
+const char *owmConditionMain(uint16_t id, const char *text);
+const char *owmConditionDescription(uint16_t id, const char *text);
+
+#endif
@@ -0,0 +1,34 @@
+/*
+  Values derived from a forecast for the OWMOneCall library.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include "OWMDerived.h"
+
+float owmHeatIndex(float tempF, float humidity) {
+  // The simple formula decides whether the full regression is needed
+  float simple = 0.5f * (tempF + 61.0f + (tempF - 68.0f) * 1.2f + humidity * 0.094f);
+  if ((simple + tempF) / 2 < 80.0f) return simple;
+
+  float t2 = tempF * tempF;
+  float h2 = humidity * humidity;
+  float index = -42.379f + 2.04901523f * tempF + 10.14333127f * humidity
+                - 0.22475541f * tempF * humidity - 0.00683783f * t2 - 0.05481717f * h2
+                + 0.00122874f * t2 * humidity + 0.00085282f * tempF * h2
+                - 0.00000199f * t2 * h2;
+
+  if (humidity < 13 && tempF >= 80 && tempF <= 112) {
+    index -= (13 - humidity) / 4 * sqrtf((17 - fabsf(tempF - 95)) / 17);
+  } else if (humidity > 85 && tempF >= 80 && tempF <= 87) {
+    index += (humidity - 85) / 10 * (87 - tempF) / 5;
+  }
+  return index;
+}
+
+float owmWindChill(float tempF, float windMph) {
+  if (tempF > 50 || windMph < 3) return tempF;
+
+  float wind = powf(windMph, 0.16f);
+  return 35.74f + 0.6215f * tempF - 35.75f * wind + 0.4275f * tempF * wind;
+}
@@ -0,0 +1,50 @@
+/*
+  Values derived from a forecast for the OWMOneCall library.
+
+  The values most displays and automations work out from the forecast arrays (time to the next
+  rain, totals and highs over the coming hours, heat index and wind chill) are computed once as
+  each response is stored, only for the sections it contained, and read from OWMForecast::derived.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWMDERIVED_H__
+#define __OWMDERIVED_H__
+
+#include <Arduino.h>
+
+// Hours covered by the hourly totals and extremes, fewer when fewer hours are stored
+#define OWM_DERIVED_HOURS 24
+
+// Values in the units set in begin().  Each group is updated with its section
+struct OWMDerived {
+  // Current
+  float heatIndex;          // Apparent temperature from temperature and humidity
+  float windChill;          // Apparent temperature from temperature and wind
+
+  // Minutely
+  int16_t minutesToPrecip;  // Minutes from the first entry to the first with precipitation, -1 for none
+  uint8_t precipMinutes;    // Entries with precipitation
+
+  // Hourly, over the first OWM_DERIVED_HOURS hours
+  float precip3h;           // Rain and snow in the first 3 hours in mm
+  float precip24h;          // Rain and snow in mm
+  float high;               // Highest temperature
+  float low;                // Lowest temperature
+  uint32_t highTime;        // Unix timestamp of the hour with the highest temperature
+  uint32_t lowTime;         // Unix timestamp of the hour with the lowest temperature
+  float maxPrecipProb;      // Highest probability of precipitation 0 - 1
+
+  // Daily
+  float weekHigh;           // Highest daily maximum temperature
+  float weekLow;            // Lowest daily minimum temperature
+  uint8_t wettestDay;       // Day with the most rain and snow, 0 for today
+};
+
+// National Weather Service formulas, in Fahrenheit and mph.  Below about 80F the heat index is
+// the simpler NWS estimate.  Wind chill applies up to 50F with at least 3 mph of wind, otherwise
+// the temperature is returned
+float owmHeatIndex(float tempF, float humidity);
+float owmWindChill(float tempF, float windMph);
+
+#endif
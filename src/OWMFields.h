@@ -0,0 +1,94 @@
+/*
+  Field tables for the OWMOneCall library.
+
+  Each section of the API response is described once, by a table giving for every field its JSON
+  key (with the member for nested objects such as temp.morn), where it is held in the record,
+  the type it is held as and how the compact encoding writes it.  The deserialization filter,
+  both parsers and the encoder work from these tables.  Keys whose values are converted rather
+  than copied, the weather condition and the alert texts, are listed in key tables that give
+  what each one holds.  Keys are matched by a hash worked out at compile time, so a value is
+  found by comparing integers rather than a chain of strings.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWMFIELDS_H__
+#define __OWMFIELDS_H__
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <type_traits>
+#include "OWMPacked.h"
+
+// FNV-1a hash of a key, continued with '.' and sub for a member of a nested object
+constexpr uint32_t owmKeyHash(const char *key, uint32_t hash = 2166136261u) {
+  return *key ? owmKeyHash(key + 1, (hash ^ (uint8_t)*key) * 16777619u) : hash;
+}
+
+constexpr uint32_t owmFieldHash(const char *key, const char *sub) {
+  return sub ? owmKeyHash(sub, (owmKeyHash(key) ^ '.') * 16777619u) : owmKeyHash(key);
+}
+
+// Type a field is held as
+enum OWMFieldType : uint8_t {
+  OWM_FIELD_U8,
+  OWM_FIELD_U16,
+  OWM_FIELD_U32,
+  OWM_FIELD_FLOAT,
+  OWM_FIELD_CENTI,    // OWMCenti
+  OWM_FIELD_CENTIU,   // OWMCentiU
+  OWM_FIELD_PERCENT   // OWMPercent
+};
+
+template <typename T> struct OWMFieldTypeOf;
+template <> struct OWMFieldTypeOf<uint8_t> { static constexpr OWMFieldType value = OWM_FIELD_U8; };
+template <> struct OWMFieldTypeOf<uint16_t> { static constexpr OWMFieldType value = OWM_FIELD_U16; };
+template <> struct OWMFieldTypeOf<uint32_t> { static constexpr OWMFieldType value = OWM_FIELD_U32; };
+template <> struct OWMFieldTypeOf<float> { static constexpr OWMFieldType value = OWM_FIELD_FLOAT; };
+template <> struct OWMFieldTypeOf<OWMCenti> { static constexpr OWMFieldType value = OWM_FIELD_CENTI; };
+template <> struct OWMFieldTypeOf<OWMCentiU> { static constexpr OWMFieldType value = OWM_FIELD_CENTIU; };
+template <> struct OWMFieldTypeOf<OWMPercent> { static constexpr OWMFieldType value = OWM_FIELD_PERCENT; };
+
+// How a field is written in the compact encoding, see OWMCodec.h
+enum OWMFieldCodec : uint8_t {
+  OWM_CODEC_NONE,       // Not encoded
+  OWM_CODEC_TIME,       // Entry timestamp, as the difference from the previous entry less the step
+  OWM_CODEC_FROM_TIME,  // Timestamp as the difference from the entry timestamp
+  OWM_CODEC_FROM_PREV,  // Timestamp as the difference from the timestamp before it
+  OWM_CODEC_UVAR,
+  OWM_CODEC_BYTE,
+  OWM_CODEC_CENTI,
+  OWM_CODEC_PERCENT
+};
+
+struct OWMField {
+  uint32_t hash;       // owmFieldHash(key, sub)
+  const char *key;
+  const char *sub;     // Member of a nested object, NULL for a plain value
+  uint16_t offset;     // Position in the record, or of the array pointer in hourlySeries
+  OWMFieldType type;
+  OWMFieldCodec codec;
+};
+
+// Table entry for member of record, read from key (and sub) of the response
+#define OWM_FIELD(record, member, key, sub, codec) \
+  { owmFieldHash(key, sub), key, sub, offsetof(record, member), \
+    OWMFieldTypeOf<decltype(record::member)>::value, codec }
+
+// Table entry for an array of hourlySeries
+#define OWM_SERIES_FIELD(member, key, sub) \
+  { owmFieldHash(key, sub), key, sub, offsetof(hourlySeries, member), \
+    OWMFieldTypeOf<std::remove_pointer<decltype(hourlySeries::member)>::type>::value, OWM_CODEC_NONE }
+
+// Key table entry, kind says what the value holds
+struct OWMKey {
+  uint32_t hash;       // owmKeyHash(key)
+  const char *key;
+  uint8_t kind;
+};
+
+#define OWM_KEY(key, kind) { owmKeyHash(key), key, kind }
+
+#define OWM_FIELD_COUNT(fields) (sizeof(fields) / sizeof(fields[0]))
+
+#endif
@@ -36,27 +36,89 @@
 //#define DEBUG1 // API Response
 
 #include "OWMOneCall.h"
+#include <new>
 
 
-OWMOneCall::OWMOneCall()
+OWMOneCall::OWMOneCall() : _json(this)
 {
   // Set check variables to the max number of forecasts returned by the API
   _maxMinRpts = 60;
   _maxHrRpts = 48;
   _maxDlyRpts = 8;
+
+  for (uint8_t i = 0; i < OWM_MAX_LOCATIONS; i++) _locations[i] = NULL;
+  _wx = this;
+
+  _polling = false;
+  _pollTime = 20;
+  _callback = NULL;
+  _stagingReady = false;
+  _pollBuffer = &_staging;
+  _doubleBufferSetting = false;
+  _doubleBuffer = false;
+  _front.store(this);
+  _sequence.store(0);
+
+  _apiCall[0] = 0;
+  _apiPrefix = 0;
+  _sections = 0;
+  _notModified = false;
+  setCacheTime(0, 0, 0, 0);
+  clearCache();
+
+  _streaming = false;
+  _transport = &_httpTransport;
+  _keepAlive = true;
+  _timeout = 5000;
+  _jsonMemory = 0;
+  _jsonAllocations = 0;
+  _measuring = false;
+  _parseMicros = 0;
+  _heapLowStart = 0;
+  resetStats();
+  _storageSetting = STORE_RECORDS;
+  _hourlyStorage = STORE_RECORDS;
+  _maxAlerts = 0;
+  _maxAlertText = 0;
+  _numAlerts = 0;
+  _alertTextLen = 0;
+  _arena = NULL;
+  _arenaEnd = 0;
+  _arenaUsed = 0;
+  _arenaSlots = 0;
+  _arenaRecords = 0;
 }
 
 OWMOneCall::~OWMOneCall()
 {
-  delete [] minWx;
-  delete [] hrWx;
-  delete [] dlyWx;
+  cancelPoll();
+  freeForecasts();
+  releaseLocations();
 }
 
-void OWMOneCall::begin(String apiKey, uint8_t cur, uint8_t min, uint8_t hr, uint8_t dly, OWMUnits units)
+// The longest location and section list getApiCall() writes after the part from begin()
+static const char API_CALL_TAIL[] = "-180.00&lon=-180.00&exclude=alerts,current,daily,hourly,minutely";
+
+bool OWMOneCall::begin(String apiKey, uint8_t cur, uint8_t min, uint8_t hr, uint8_t dly, OWMUnits units)
 {
     _units = units;
-    _apiKey = apiKey;
+
+    // The units and key only change here, so they come first and each request rewrites the
+    // rest of the API call
+    const char *unitString = units == IMPERIAL ? "units=imperial&" : (units == METRIC ? "units=metric&" : "");
+    int length = snprintf(_apiCall, sizeof(_apiCall), "http://api.openweathermap.org/data/3.0/onecall?%sAPPID=%s&lat=",
+                          unitString, apiKey.c_str());
+    if (length < 0 || length + sizeof(API_CALL_TAIL) > sizeof(_apiCall)) {
+      // No room for the location, requests fail until begin() is called with a shorter key
+      // or a larger OWM_API_CALL_SIZE
+      _apiCall[0] = 0;
+      _apiPrefix = 0;
+      #ifdef DEBUG
+        Serial.println(F("API key too long for OWM_API_CALL_SIZE"));
+      #endif
+      return false;
+    }
+    _apiPrefix = length;
 
     if (cur > 0) {
       _currentSize = 511;  // Not needed with ArduinoJSON v7
@@ -74,9 +136,9 @@ void OWMOneCall::begin(String apiKey, uint8_t cur, uint8_t min, uint8_t hr, uint
       } else {
         _numMinRpts = min;
       }
-      minWx = new minuteWeather[_numMinRpts];
     } else {
       _minuteSize = 0;  // Not needed with ArduinoJSON v7
+      _numMinRpts = 0;
     }
 
     if (hr > 0) {
@@ -86,9 +148,9 @@ void OWMOneCall::begin(String apiKey, uint8_t cur, uint8_t min, uint8_t hr, uint
       } else {
         _numHrRpts = hr;
       }
-      hrWx = new hourlyWeather[_numHrRpts];
     } else {
       _hourSize = 0;  // Not needed with ArduinoJSON v7
+      _numHrRpts = 0;
     }
 
     if (dly > 0) {
@@ -98,10 +160,43 @@ void OWMOneCall::begin(String apiKey, uint8_t cur, uint8_t min, uint8_t hr, uint
       } else {
         _numDlyRpts = dly;
       }
-      dlyWx = new dailyWeather[_numDlyRpts];
     } else {
       _dailySize = 0;  // Not needed with ArduinoJSON v7
+      _numDlyRpts = 0;
+    }
+
+    _numAlerts = _maxAlerts;
+    _alertTextLen = (uint32_t)_maxAlertText + 1;
+    _hourlyStorage = _storageSetting;
+    _doubleBuffer = _doubleBufferSetting;
+
+    // Resize the forecasts of every location to the new counts.  The arena is handed out
+    // again from the start, including to the records of removed locations kept for reuse
+    cancelPoll();
+    freeForecasts();
+    _arenaUsed = 0;
+    bool allocated = allocateForecast(*this);
+    if (_doubleBuffer) allocated = allocateForecast(_back) && allocated;
+    _front.store(this, std::memory_order_release);
+    clearCache();
+    for (uint8_t i = 0; i < OWM_MAX_LOCATIONS; i++) {
+      OWMLocation *location = _arenaRecords & (1UL << i) ? arenaRecord(i) : _locations[i];
+      if (!location) continue;
+      allocated = allocateForecast(location->forecast) && allocated;
+      location->updated = false;
+    }
+
+    if (!allocated) {
+      // Too little arena or heap for these counts, request and store nothing rather than part
+      _currentRpt = false;
+      _numMinRpts = _numHrRpts = _numDlyRpts = _numAlerts = 0;
+      freeForecasts();
+      _arenaUsed = 0;
+      #ifdef DEBUG
+        Serial.println(F("Forecasts don't fit in memory"));
+      #endif
     }
+    buildFilter();
 
     #ifdef DEBUG
       Serial.print(F("Report requested for: "));
@@ -113,6 +208,7 @@ void OWMOneCall::begin(String apiKey, uint8_t cur, uint8_t min, uint8_t hr, uint
       Serial.print(_numDlyRpts);
       Serial.println(F(" days."));
     #endif
+    return allocated;
 }
 
 void OWMOneCall::setLocation(float latitude, float longitude) {
@@ -141,6 +237,259 @@ void OWMOneCall::setLocation(float latitude, float longitude) {
     Serial.print(F(", "));
     Serial.println(_lon);
   #endif
+
+  clearCache();  // The cached forecast is for the previous location
+}
+
+template <typename T>
+T *OWMOneCall::allocate(size_t count) {
+  if (!_arena) return new (std::nothrow) T[count];
+
+  T *array = (T *)arenaTake(count * sizeof(T));
+  for (size_t i = 0; array && i < count; i++) new (&array[i]) T();
+  return array;
+}
+
+template <typename T>
+void OWMOneCall::release(T *array) {
+  // Arena arrays hold no resources and are taken back all at once by begin()
+  if (!_arena) delete [] array;
+}
+
+bool OWMOneCall::allocateForecast(OWMForecast &wx) {
+  size_t arenaUsed = _arenaUsed;
+  bool allocated = true;
+
+  if (_numMinRpts > 0) allocated = (wx.minWx = allocate<minuteWeather>(_numMinRpts)) != NULL;
+  if (_numHrRpts > 0 && _hourlyStorage != STORE_SERIES && allocated) {
+    allocated = (wx.hrWx = allocate<hourlyRecord>(_numHrRpts)) != NULL;
+  }
+  if (_numDlyRpts > 0 && allocated) allocated = (wx.dlyWx = allocate<dailyRecord>(_numDlyRpts)) != NULL;
+
+  if (_numHrRpts > 0 && _hourlyStorage != STORE_RECORDS && allocated) {
+    // One block for all the float series keeps them contiguous with a single allocation
+    uint8_t hours = _numHrRpts;
+    uint32_t *time = allocate<uint32_t>(hours);
+    float *block = time ? allocate<float>(OWM_SERIES_FIELDS * hours) : NULL;
+
+    if (block) {
+      wx.hrSeries.count = hours;
+      wx.hrSeries.time = time;
+      wx.hrSeries.temp = block;
+      wx.hrSeries.feelsLike = block += hours;
+      wx.hrSeries.dewPoint = block += hours;
+      wx.hrSeries.precipProb = block += hours;
+      wx.hrSeries.windSpeed = block += hours;
+      wx.hrSeries.windGust = block += hours;
+      wx.hrSeries.uvi = block += hours;
+      wx.hrSeries.rain = block += hours;
+      wx.hrSeries.snow = block += hours;
+      wx.hrSeries.clouds = block += hours;
+      wx.hrSeries.humidity = block += hours;
+      wx.hrSeries.pressure = block += hours;
+    }
+    allocated = block != NULL;
+  }
+
+  if (_numAlerts > 0 && allocated) {
+    // The text of every alert in one block
+    size_t size = OWM_ALERT_SENDER_LEN + OWM_ALERT_EVENT_LEN + _alertTextLen;
+    char *text = allocate<char>(_numAlerts * size);
+
+    wx.alertWx = text ? allocate<alertWeather>(_numAlerts) : NULL;
+    for (uint8_t i = 0; wx.alertWx && i < _numAlerts; i++, text += size) {
+      wx.alertWx[i].sender = text;
+      wx.alertWx[i].event = text + OWM_ALERT_SENDER_LEN;
+      wx.alertWx[i].description = text + OWM_ALERT_SENDER_LEN + OWM_ALERT_EVENT_LEN;
+    }
+    allocated = wx.alertWx != NULL;
+  }
+  wx.alertCount = 0;
+
+  if (!allocated) {
+    // The arena or the heap ran out, give back what was taken
+    freeForecast(wx);
+    _arenaUsed = arenaUsed;
+  }
+  return allocated;
+}
+
+void OWMOneCall::freeForecast(OWMForecast &wx) {
+  release(wx.minWx);
+  release(wx.hrWx);
+  release(wx.dlyWx);
+  release(wx.hrSeries.time);
+  release(wx.hrSeries.temp);  // Start of the block holding every float series
+  if (wx.alertWx) release(wx.alertWx[0].sender);  // Start of the block holding the alert text
+  release(wx.alertWx);
+
+  wx.minWx = NULL;
+  wx.hrWx = NULL;
+  wx.dlyWx = NULL;
+  wx.hrSeries = hourlySeries();
+  wx.alertWx = NULL;
+  wx.alertCount = 0;
+}
+
+void OWMOneCall::freeForecasts() {
+  freeForecast(*this);
+  freeForecast(_staging);
+  _stagingReady = false;
+  freeForecast(_back);
+  for (uint8_t i = 0; i < OWM_MAX_LOCATIONS; i++) {
+    OWMLocation *location = _arenaRecords & (1UL << i) ? arenaRecord(i) : _locations[i];
+    if (location) freeForecast(location->forecast);
+  }
+}
+
+void *OWMOneCall::arenaTake(size_t size) {
+  size_t free = _arenaEnd - _arenaSlots * OWM_LOCATION_SIZE - _arenaUsed;
+
+  size = OWM_ARENA_ALIGN(size);
+  if (size > free) return NULL;
+
+  void *memory = _arena + _arenaUsed;
+  _arenaUsed += size;
+  return memory;
+}
+
+OWMLocation *OWMOneCall::arenaRecord(uint8_t slot) {
+  return (OWMLocation *)(_arena + _arenaEnd - (slot + 1) * OWM_LOCATION_SIZE);
+}
+
+// The record for slot, built with its forecast the first time the slot is used
+OWMLocation *OWMOneCall::arenaLocation(uint8_t slot) {
+  OWMLocation *location = arenaRecord(slot);
+  if (_arenaRecords & (1UL << slot)) return location;
+
+  uint8_t slots = _arenaSlots;
+  if (slot >= slots) {
+    if ((size_t)(slot + 1) * OWM_LOCATION_SIZE > _arenaEnd - _arenaUsed) return NULL;
+    _arenaSlots = slot + 1;
+  }
+
+  new (location) OWMLocation();
+  if (!allocateForecast(location->forecast)) {
+    location->~OWMLocation();
+    _arenaSlots = slots;
+    return NULL;
+  }
+  _arenaRecords |= 1UL << slot;
+  return location;
+}
+
+// Remove every location and the records kept for them in the arena
+void OWMOneCall::releaseLocations() {
+  for (uint8_t i = 0; i < OWM_MAX_LOCATIONS; i++) {
+    removeLocation(i);
+    if (_arenaRecords & (1UL << i)) arenaRecord(i)->~OWMLocation();
+  }
+  _arenaSlots = 0;
+  _arenaRecords = 0;
+}
+
+void OWMOneCall::setArena(void *buffer, size_t size) {
+  // Everything taken from the old memory goes back first
+  cancelPoll();
+  freeForecasts();
+  releaseLocations();
+  _front.store(this, std::memory_order_release);
+  clearCache();
+
+  // Nothing is requested or stored until begin() sizes the forecasts again
+  _currentRpt = false;
+  _numMinRpts = _numHrRpts = _numDlyRpts = _numAlerts = 0;
+
+  // Start on an 8 byte boundary
+  uintptr_t start = OWM_ARENA_ALIGN((uintptr_t)buffer);
+  size_t skip = start - (uintptr_t)buffer;
+
+  _arena = buffer ? (uint8_t *)start : NULL;
+  _arenaEnd = buffer && size > skip ? (size - skip) & ~(size_t)7 : 0;
+  _arenaUsed = 0;
+}
+
+size_t OWMOneCall::getArenaUsed() {
+  return _arena ? _arenaUsed + _arenaSlots * OWM_LOCATION_SIZE : 0;
+}
+
+int8_t OWMOneCall::addLocation(float latitude, float longitude) {
+  if (latitude > 90 || latitude < -90 || longitude > 180 || longitude < -180) return -1;
+
+  for (uint8_t i = 0; i < OWM_MAX_LOCATIONS; i++) {
+    if (_locations[i]) continue;
+
+    OWMLocation *location;
+    if (_arena) {
+      location = arenaLocation(i);
+      if (!location) return -1;  // The arena is full
+    } else {
+      location = new (std::nothrow) OWMLocation();
+      if (!location) return -1;  // Out of memory
+      if (!allocateForecast(location->forecast)) {
+        delete location;
+        return -1;  // Out of memory
+      }
+    }
+    location->latitude = latitude;
+    location->longitude = longitude;
+    location->updated = false;
+    _locations[i] = location;
+    return i;
+  }
+  return -1;
+}
+
+void OWMOneCall::removeLocation(uint8_t slot) {
+  if (slot >= OWM_MAX_LOCATIONS || !_locations[slot]) return;
+
+  // A record in the arena stays with its forecast for the next location added in the slot
+  if (!_arena) {
+    freeForecast(_locations[slot]->forecast);
+    delete _locations[slot];
+  }
+  _locations[slot] = NULL;
+}
+
+OWMLocation *OWMOneCall::getLocation(uint8_t slot) {
+  return slot < OWM_MAX_LOCATIONS ? _locations[slot] : NULL;
+}
+
+void OWMOneCall::setHourlyStorage(OWMStorage storage) {
+  _storageSetting = storage;
+}
+
+void OWMOneCall::setAlerts(uint8_t count, uint16_t textLength) {
+  _maxAlerts = count;
+  _maxAlertText = textLength;
+}
+
+void OWMOneCall::setKeepAlive(bool keepAlive) {
+  _keepAlive = keepAlive;
+  if (!keepAlive) disconnect();
+}
+
+void OWMOneCall::setTimeout(uint16_t timeout) {
+  _timeout = timeout;
+}
+
+void OWMOneCall::disconnect() {
+  _transport->disconnect();
+}
+
+void OWMOneCall::setTransport(OWMTransport *transport) {
+  cancelPoll();
+  _transport->disconnect();
+  _transport = transport ? transport : &_httpTransport;
+}
+
+void OWMOneCall::setStreaming(bool streaming) {
+  _streaming = streaming;
+
+  #ifdef DEBUG
+    Serial.print(F("Streaming mode: "));
+    Serial.println(_streaming ? F("on") : F("off"));
+  #endif
 }
 
 uint16_t OWMOneCall::getJsonSize() {  // Not needed with ArduinoJSON v7
@@ -168,191 +517,1729 @@ uint16_t OWMOneCall::getJsonSize() {  // Not needed with ArduinoJSON v7
 
 }
 
-String OWMOneCall::getApiCall() {
-    String apiCall;
-    String excludes = "&exclude=alerts";
-    String unitString;
+// Fields read from each section of the API response, in the order of the compact encoding.
+// The order is part of the format, so changes need a new OWM_CODEC_VERSION
+static constexpr OWMField _currentFields[] = {
+  OWM_FIELD(currentWeather, time, "dt", NULL, OWM_CODEC_TIME),
+  OWM_FIELD(currentWeather, sunrise, "sunrise", NULL, OWM_CODEC_FROM_TIME),
+  OWM_FIELD(currentWeather, sunset, "sunset", NULL, OWM_CODEC_FROM_PREV),
+  OWM_FIELD(currentWeather, temp, "temp", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(currentWeather, feelsLike, "feels_like", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(currentWeather, pressure, "pressure", NULL, OWM_CODEC_UVAR),
+  OWM_FIELD(currentWeather, humidity, "humidity", NULL, OWM_CODEC_BYTE),
+  OWM_FIELD(currentWeather, dewPoint, "dew_point", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(currentWeather, clouds, "clouds", NULL, OWM_CODEC_BYTE),
+  OWM_FIELD(currentWeather, uvi, "uvi", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(currentWeather, visibility, "visibility", NULL, OWM_CODEC_UVAR),
+  OWM_FIELD(currentWeather, windSpeed, "wind_speed", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(currentWeather, windGust, "wind_gust", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(currentWeather, windDir, "wind_deg", NULL, OWM_CODEC_UVAR),
+  OWM_FIELD(currentWeather, rain, "rain", "1h", OWM_CODEC_CENTI),
+  OWM_FIELD(currentWeather, snow, "snow", "1h", OWM_CODEC_CENTI),
+};
+
+static constexpr OWMField _minuteFields[] = {
+  OWM_FIELD(minuteWeather, time, "dt", NULL, OWM_CODEC_TIME),
+  OWM_FIELD(minuteWeather, precip, "precipitation", NULL, OWM_CODEC_CENTI),
+};
+
+static constexpr OWMField _hourFields[] = {
+  OWM_FIELD(hourlyRecord, time, "dt", NULL, OWM_CODEC_TIME),
+  OWM_FIELD(hourlyRecord, temp, "temp", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(hourlyRecord, feelsLike, "feels_like", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(hourlyRecord, pressure, "pressure", NULL, OWM_CODEC_UVAR),
+  OWM_FIELD(hourlyRecord, humidity, "humidity", NULL, OWM_CODEC_BYTE),
+  OWM_FIELD(hourlyRecord, dewPoint, "dew_point", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(hourlyRecord, uvi, "uvi", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(hourlyRecord, clouds, "clouds", NULL, OWM_CODEC_BYTE),
+  OWM_FIELD(hourlyRecord, visibility, "visibility", NULL, OWM_CODEC_UVAR),
+  OWM_FIELD(hourlyRecord, windSpeed, "wind_speed", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(hourlyRecord, windGust, "wind_gust", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(hourlyRecord, windDir, "wind_deg", NULL, OWM_CODEC_UVAR),
+  OWM_FIELD(hourlyRecord, precipProb, "pop", NULL, OWM_CODEC_PERCENT),
+  OWM_FIELD(hourlyRecord, rain, "rain", "1h", OWM_CODEC_CENTI),
+  OWM_FIELD(hourlyRecord, snow, "snow", "1h", OWM_CODEC_CENTI),
+};
+
+static constexpr OWMField _dayFields[] = {
+  OWM_FIELD(dailyRecord, time, "dt", NULL, OWM_CODEC_TIME),
+  OWM_FIELD(dailyRecord, sunrise, "sunrise", NULL, OWM_CODEC_FROM_TIME),
+  OWM_FIELD(dailyRecord, sunset, "sunset", NULL, OWM_CODEC_FROM_PREV),
+  OWM_FIELD(dailyRecord, moonrise, "moonrise", NULL, OWM_CODEC_FROM_TIME),
+  OWM_FIELD(dailyRecord, moonset, "moonset", NULL, OWM_CODEC_FROM_PREV),
+  OWM_FIELD(dailyRecord, moonPhase, "moon_phase", NULL, OWM_CODEC_PERCENT),
+  OWM_FIELD(dailyRecord, morningTemp, "temp", "morn", OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, dayTemp, "temp", "day", OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, eveTemp, "temp", "eve", OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, nightTemp, "temp", "night", OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, maxTemp, "temp", "max", OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, minTemp, "temp", "min", OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, mornFeels, "feels_like", "morn", OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, dayFeels, "feels_like", "day", OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, eveFeels, "feels_like", "eve", OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, nightFeels, "feels_like", "night", OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, pressure, "pressure", NULL, OWM_CODEC_UVAR),
+  OWM_FIELD(dailyRecord, humidity, "humidity", NULL, OWM_CODEC_BYTE),
+  OWM_FIELD(dailyRecord, dewPoint, "dew_point", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, uvi, "uvi", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, clouds, "clouds", NULL, OWM_CODEC_BYTE),
+  OWM_FIELD(dailyRecord, windSpeed, "wind_speed", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, windGust, "wind_gust", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, windDir, "wind_deg", NULL, OWM_CODEC_UVAR),
+  OWM_FIELD(dailyRecord, precipProb, "pop", NULL, OWM_CODEC_PERCENT),
+  OWM_FIELD(dailyRecord, rain, "rain", NULL, OWM_CODEC_CENTI),
+  OWM_FIELD(dailyRecord, snow, "snow", NULL, OWM_CODEC_CENTI),
+};
+
+// The hourly values kept as series, with the same keys as the hourly records
+static constexpr OWMField _seriesFields[] = {
+  OWM_SERIES_FIELD(time, "dt", NULL),
+  OWM_SERIES_FIELD(temp, "temp", NULL),
+  OWM_SERIES_FIELD(feelsLike, "feels_like", NULL),
+  OWM_SERIES_FIELD(pressure, "pressure", NULL),
+  OWM_SERIES_FIELD(humidity, "humidity", NULL),
+  OWM_SERIES_FIELD(dewPoint, "dew_point", NULL),
+  OWM_SERIES_FIELD(uvi, "uvi", NULL),
+  OWM_SERIES_FIELD(clouds, "clouds", NULL),
+  OWM_SERIES_FIELD(windSpeed, "wind_speed", NULL),
+  OWM_SERIES_FIELD(windGust, "wind_gust", NULL),
+  OWM_SERIES_FIELD(precipProb, "pop", NULL),
+  OWM_SERIES_FIELD(rain, "rain", "1h"),
+  OWM_SERIES_FIELD(snow, "snow", "1h"),
+};
+
+// Members of the first weather condition, the same in every section
+enum ConditionKey : uint8_t { CONDITION_ID, CONDITION_MAIN, CONDITION_DESCRIPTION, CONDITION_ICON };
+
+static constexpr OWMKey _conditionKeys[] = {
+  OWM_KEY("id", CONDITION_ID),
+  OWM_KEY("main", CONDITION_MAIN),
+  OWM_KEY("description", CONDITION_DESCRIPTION),
+  OWM_KEY("icon", CONDITION_ICON),
+};
+
+// Members of an alert, only read by the stream parser
+enum AlertKey : uint8_t { ALERT_START, ALERT_END, ALERT_SENDER, ALERT_EVENT, ALERT_DESCRIPTION };
+
+static constexpr OWMKey _alertKeys[] = {
+  OWM_KEY("start", ALERT_START),
+  OWM_KEY("end", ALERT_END),
+  OWM_KEY("sender_name", ALERT_SENDER),
+  OWM_KEY("event", ALERT_EVENT),
+  OWM_KEY("description", ALERT_DESCRIPTION),
+};
+
+static const OWMKey *findKey(const OWMKey *keys, size_t count, const char *key) {
+  uint32_t hash = owmKeyHash(key);
+  for (size_t i = 0; i < count; i++) {
+    if (keys[i].hash == hash && !strcmp(keys[i].key, key)) return &keys[i];
+  }
+  return NULL;
+}
+
+static void addKeys(JsonObject section, const OWMKey *keys, size_t count) {
+  for (size_t i = 0; i < count; i++) section[keys[i].key] = true;
+}
+
+// Keys of a field table.  Nested objects keep only the members in the table
+static void addFields(JsonObject section, const OWMField *fields, size_t count, bool condition) {
+  for (size_t i = 0; i < count; i++) {
+    if (fields[i].sub) section[fields[i].key][fields[i].sub] = true;
+    else section[fields[i].key] = true;
+  }
+  if (condition) addKeys(section["weather"].add<JsonObject>(), _conditionKeys, OWM_FIELD_COUNT(_conditionKeys));
+}
+
+void OWMOneCall::buildFilter() {
+  _filter.clear();
+  _filter["timezone"] = true;
+  _filter["timezone_offset"] = true;
+
+  // ArduinoJson applies the first element of an array filter to every element, so entries past
+  // the requested count are still kept but reduced to the keys below
+  if (_currentRpt) addFields(_filter["current"].to<JsonObject>(), _currentFields, OWM_FIELD_COUNT(_currentFields), true);
+  if (_numMinRpts > 0) addFields(_filter["minutely"].add<JsonObject>(), _minuteFields, OWM_FIELD_COUNT(_minuteFields), false);
+  if (_numHrRpts > 0) addFields(_filter["hourly"].add<JsonObject>(), _hourFields, OWM_FIELD_COUNT(_hourFields), true);
+  if (_numDlyRpts > 0) addFields(_filter["daily"].add<JsonObject>(), _dayFields, OWM_FIELD_COUNT(_dayFields), true);
+}
+
+size_t OWMOneCall::getJsonMemory() {
+  return _jsonMemory;
+}
+
+uint32_t OWMOneCall::getJsonAllocations() {
+  return _jsonAllocations;
+}
+
+const OWMStats &OWMOneCall::getStats() {
+  return _stats;
+}
+
+void OWMOneCall::resetStats() {
+  _stats = OWMStats();
+}
+
+// Keep the lowest free heap of the request being measured
+void OWMOneCall::sampleHeap() {
+  uint32_t heap = ESP.getFreeHeap();
+  if (_measuring && heap < _stats.freeHeap) _stats.freeHeap = heap;
+}
+
+// Degrees to two decimals in integer arithmetic, as printing a float can allocate memory.
+// Values out of range, which setLocation() and addLocation() don't accept, are written as 0
+static void formatCoordinate(char *buf, size_t size, float value) {
+  if (!(value >= -180 && value <= 180)) value = 0;
+  long centi = lroundf(value * 100);
+  unsigned long magnitude = centi < 0 ? -centi : centi;
+
+  snprintf(buf, size, "%s%lu.%02lu", centi < 0 ? "-" : "", magnitude / 100, magnitude % 100);
+}
+
+const char *OWMOneCall::getApiCall(float lat, float lon) {
+    // Sized for any long, the values themselves are at most 7 characters
+    char latitude[24];
+    char longitude[24];
 
-    if (!_currentRpt) excludes += ",current";
-    if (_numDlyRpts < 1) excludes += ",daily";
-    if (_numHrRpts < 1) excludes += ",hourly";
-    if (_numMinRpts < 1) excludes += ",minutely";
+    formatCoordinate(latitude, sizeof(latitude), lat);
+    formatCoordinate(longitude, sizeof(longitude), lon);
 
-   switch (_units) {
-    case IMPERIAL:
-      unitString = "&units=imperial&APPID=";
-      break;
-    case METRIC:
-      unitString = "&units=metric&APPID=";
-      break;
-    case STANDARD:
-    default:
-      unitString = "&APPID=";
-      break;
-   }
+    // Sections not requested, each after a comma that is dropped from the first
+    char excludes[48];
+    snprintf(excludes, sizeof(excludes), "%s%s%s%s%s",
+             (_sections & OWM_ALERTS) ? "" : ",alerts",
+             (_sections & OWM_CURRENT) ? "" : ",current",
+             (_sections & OWM_DAILY) ? "" : ",daily",
+             (_sections & OWM_HOURLY) ? "" : ",hourly",
+             (_sections & OWM_MINUTELY) ? "" : ",minutely");
 
-    apiCall = "http://api.openweathermap.org/data/3.0/onecall?lat=" + String(_lat,2) + "&lon=" + String(_lon, 2) + excludes + unitString + _apiKey;
+    snprintf(_apiCall + _apiPrefix, sizeof(_apiCall) - _apiPrefix, "%s&lon=%s%s%s",
+             latitude, longitude, excludes[0] ? "&exclude=" : "", excludes[0] ? excludes + 1 : "");
 
-    return apiCall; 
+    return _apiCall;
+}
 
+uint8_t OWMOneCall::requestedSections() {
+  return (_currentRpt ? OWM_CURRENT : 0) | (_numMinRpts ? OWM_MINUTELY : 0) |
+         (_numHrRpts ? OWM_HOURLY : 0) | (_numDlyRpts ? OWM_DAILY : 0) | (_numAlerts ? OWM_ALERTS : 0);
 }
 
 bool OWMOneCall::getWeather() {
+  if (_polling) return false;  // The client is in use by poll()
+
+  _sections = staleSections();
+  if (!_sections) return true;  // The stored forecast is recent enough
+
+  OWMForecast *wx = beginUpdate();
+  keepSections(*wx);
+  bool parsed = fetch(_lat, _lon, *wx, true);
+  endUpdate(wx, parsed && !_notModified);
+  return parsed;
+}
+
+uint8_t OWMOneCall::getWeatherAll() {
+  uint8_t updated = 0;
+
+  if (_polling) return 0;
+  _sections = requestedSections();
+
+  for (uint8_t i = 0; i < OWM_MAX_LOCATIONS; i++) {
+    OWMLocation *location = _locations[i];
+    if (!location) continue;
+
+    location->updated = fetch(location->latitude, location->longitude, location->forecast);
+    if (location->updated) updated++;
+  }
+  return updated;
+}
+
+bool OWMOneCall::fetch(float lat, float lon, OWMForecast &wx, bool cached) {
+  bool parsed = false;
+
+  if (_polling) return false;  // The client is in use by poll()
+  if (!_apiPrefix) return false;  // No API call until begin() succeeds
+
+  _wx = &wx;
+  if (sendRequest(lat, lon, cached)) {
+    if (_notModified) {
+      parsed = true;  // The forecast held is still current
+    } else if (_streaming || _numAlerts) {
+      // Alerts are always streamed, so each description is cut to the alert memory as it
+      // arrives.  In document mode the whole response, every description included, would be
+      // held first.  HTTP/1.1 is needed to keep the connection open, so the body may arrive
+      // in chunks
+      parsed = parseStream(_transport->stream(), _transport->chunked(), _transport->size());
+    } else {
+      String payload = _transport->getString();
+      #ifdef DEBUG1
+        Serial.println(payload);
+      #endif
+      _stats.payloadBytes = payload.length();
+      sampleHeap();
+      unsigned long start = micros();
+      parsed = parseDocument(payload);
+      _parseMicros += micros() - start;
+      _stats.jsonMemory = _jsonMemory;
+    }
+  }
+  if (parsed && cached) updateCache();
+  endRequest(parsed);
+  _wx = this;
+  return parsed; 
+}
+
+bool OWMOneCall::sendRequest(float lat, float lon, bool cached) {
+  const char *etag = startRequest(lat, lon, cached);
+  return checkResponse(_transport->get(_apiCall, etag, _keepAlive, _timeout), cached);
+}
+
+// Build the API call and start the statistics of a request.  Returns the ETag to send with it
+const char *OWMOneCall::startRequest(float lat, float lon, bool cached) {
   
-  String payload;
-  String apiCall = getApiCall();
+  getApiCall(lat, lon);
   #ifdef DEBUG
-    Serial.println(apiCall);
+    Serial.println(_apiCall);
   #endif
-  uint16_t jsonSize = getJsonSize();  // Not needed with ArduinoJSON v7
-  HTTPClient http;
-  JsonDocument wxData;
 
-  http.begin(apiCall);
-  uint16_t httpCode = http.GET();
-  
-    if (httpCode > 0) {
-	    payload = http.getString();
-        #ifdef DEBUG1
-          Serial.println(payload);
-        #endif
-        DeserializationError wxError = deserializeJson(wxData, payload);
-        if (!wxError) {
-          // Store Timezone Info
-          timeZone = wxData["timezone"].as<String>();
-          timeZoneOffset = wxData["timezone_offset"];
-          
-          // Store Current Weather
-          if (_currentRpt) {
-            currWx.time = wxData["current"]["dt"];
-            currWx.sunrise = wxData["current"]["sunrise"];
-            currWx.sunset = wxData["current"]["sunset"];
-            currWx.temp = wxData["current"]["temp"];
-            currWx.feelsLike = wxData["current"]["feels_like"];
-            currWx.pressure = wxData["current"]["pressure"];
-            currWx.humidity = wxData["current"]["humidity"];
-            currWx.dewPoint = wxData["current"]["dew_point"];
-            currWx.clouds = wxData["current"]["clouds"];
-            currWx.uvi = wxData["current"]["uvi"];
-            currWx.visibility = wxData["current"]["visibility"];
-            currWx.windSpeed = wxData["current"]["wind_speed"];
-            currWx.windGust = wxData["current"]["wind_gust"];
-            currWx.windDir = wxData["current"]["wind_deg"];
-            currWx.rain = wxData["current"]["rain"]["1hr"];
-            currWx.snow = wxData["current"]["snow"]["1hr"];
-            currWx.id = wxData["current"]["weather"][0]["id"];
-            currWx.main = wxData["current"]["weather"][0]["main"].as<String>();
-            currWx.description = wxData["current"]["weather"][0]["description"].as<String>();
-            currWx.ico = convertIcon(wxData["current"]["weather"][0]["icon"].as<String>());
-          }
+  // Statistics of this request, recorded by endRequest()
+  _measuring = true;
+  _requestStart = millis();
+  _parseMicros = 0;
+  _stats.error = OWM_ERROR_NONE;
+  _stats.payloadBytes = 0;
+  _stats.jsonMemory = 0;
+  _stats.freeHeap = ESP.getFreeHeap();
+  _heapLowStart = ESP.getMinFreeHeap();
 
-          // Store Minutely Weather
-          if (_numMinRpts > 0) {
-            for (int i = 0; i < _numMinRpts; i++) {
-              minWx[i].time = wxData["minutely"][i]["dt"];
-              minWx[i].precip = wxData["minutely"][i]["precipitation"];
-            }
-          }
+  // The ETag only applies to a request for the same sections
+  bool etag = cached && _etagSections == _sections;
+  return etag ? _etag.c_str() : "";
+}
 
-          // Store Hourly Weather
-          if (_numHrRpts > 0) {
-            for (int i = 0; i < _numHrRpts; i++) {
-               hrWx[i].time = wxData["hourly"][i]["dt"];
-               hrWx[i].temp = wxData["hourly"][i]["temp"];
-               hrWx[i].feelsLike = wxData["hourly"][i]["feels_like"];
-               hrWx[i].pressure = wxData["hourly"][i]["pressure"];
-               hrWx[i].humidity = wxData["hourly"][i]["humidity"];
-               hrWx[i].dewPoint = wxData["hourly"][i]["dew_point"];
-               hrWx[i].clouds = wxData["hourly"][i]["clouds"];
-               hrWx[i].uvi = wxData["hourly"][i]["uvi"];
-               hrWx[i].visibility = wxData["hourly"][i]["visibility"];
-               hrWx[i].windSpeed = wxData["hourly"][i]["wind_speed"];
-               hrWx[i].windGust = wxData["hourly"][i]["wind_gust"];
-               hrWx[i].windDir = wxData["hourly"][i]["wind_deg"];
-               hrWx[i].precipProb = wxData["hourly"][i]["pop"];
-               hrWx[i].rain = wxData["hourly"][i]["rain"]["1hr"];
-               hrWx[i].snow = wxData["hourly"][i]["snow"]["1hr"];
-               hrWx[i].id = wxData["hourly"][i]["weather"][0]["id"];
-               hrWx[i].main = wxData["hourly"][i]["weather"][0]["main"].as<String>();
-               hrWx[i].description = wxData["hourly"][i]["weather"][0]["description"].as<String>();
-               hrWx[i].ico = convertIcon(wxData["hourly"][i]["weather"][0]["icon"].as<String>()); 
-            }
-          }
+// Record the status of the response to the request sent.  Returns true when its body is to be
+// read, false on an error
+bool OWMOneCall::checkResponse(int httpCode, bool cached) {
+  _notModified = cached && httpCode == HTTP_CODE_NOT_MODIFIED;
 
-          // Store Daily Weather
-          if (_numDlyRpts > 0) {
-            for (int i = 0; i < _numDlyRpts; i++) {
-               dlyWx[i].time = wxData["daily"][i]["dt"];
-               dlyWx[i].sunrise = wxData["daily"][i]["sunrise"];
-               dlyWx[i].sunset = wxData["daily"][i]["sunset"];
-               dlyWx[i].moonrise = wxData["daily"][i]["moonrise"];
-               dlyWx[i].moonset = wxData["daily"][i]["moonset"];
-               dlyWx[i].moonPhase = wxData["daily"][i]["moon_phase"];
-               dlyWx[i].morningTemp = wxData["daily"][i]["temp"]["morn"];
-               dlyWx[i].dayTemp = wxData["daily"][i]["temp"]["day"];
-               dlyWx[i].eveTemp = wxData["daily"][i]["temp"]["eve"];
-               dlyWx[i].nightTemp = wxData["daily"][i]["temp"]["night"];
-               dlyWx[i].maxTemp = wxData["daily"][i]["temp"]["max"];
-               dlyWx[i].minTemp = wxData["daily"][i]["temp"]["min"];
-               dlyWx[i].mornFeels = wxData["daily"][i]["feels_like"]["morn"];
-               dlyWx[i].dayFeels = wxData["daily"][i]["feels_like"]["day"];
-               dlyWx[i].eveFeels = wxData["daily"][i]["feels_like"]["eve"];
-               dlyWx[i].nightFeels = wxData["daily"][i]["feels_like"]["night"];
-               dlyWx[i].pressure = wxData["daily"][i]["pressure"];
-               dlyWx[i].humidity = wxData["daily"][i]["humidity"];
-               dlyWx[i].dewPoint = wxData["daily"][i]["dew_point"];
-               dlyWx[i].clouds = wxData["daily"][i]["clouds"];
-               dlyWx[i].uvi = wxData["daily"][i]["uvi"];
-               dlyWx[i].windSpeed = wxData["daily"][i]["wind_speed"];
-               dlyWx[i].windGust = wxData["daily"][i]["wind_gust"];
-               dlyWx[i].windDir = wxData["daily"][i]["wind_deg"];
-               dlyWx[i].precipProb = wxData["daily"][i]["pop"];
-               dlyWx[i].rain = wxData["daily"][i]["rain"];
-               dlyWx[i].snow = wxData["daily"][i]["snow"];
-               dlyWx[i].id = wxData["daily"][i]["weather"][0]["id"];
-               dlyWx[i].main = wxData["daily"][i]["weather"][0]["main"].as<String>();
-               dlyWx[i].description = wxData["daily"][i]["weather"][0]["description"].as<String>();
-               dlyWx[i].ico = convertIcon(wxData["daily"][i]["weather"][0]["icon"].as<String>());    
-            }
-          }
+  _bodyStart = millis();
+  _stats.httpCode = httpCode;
+  uint32_t connect = _transport->connectTime();
+  _stats.lookupMs = _transport->lookupTime();
+  _stats.connectMs = connect - (_stats.lookupMs < connect ? _stats.lookupMs : connect);
+  _stats.firstByteMs = _bodyStart - _requestStart;
+  _stats.firstByteMs -= connect < _stats.firstByteMs ? connect : _stats.firstByteMs;
+  sampleHeap();
 
-        } else {
-        #ifdef DEBUG
-          Serial.print(F("Weather data JSON error: "));
-          Serial.println(wxError.c_str());
-        #endif
-        return false;
-        }
-     
+  if (httpCode <= 0) {
+    if (httpCode == HTTPC_ERROR_CONNECTION_REFUSED) _stats.error = OWM_ERROR_CONNECT;
+    else if (httpCode == HTTPC_ERROR_READ_TIMEOUT) _stats.error = OWM_ERROR_TIMEOUT;
+    else _stats.error = OWM_ERROR_SEND;
+    #ifdef DEBUG
+      Serial.print(F("API Call error"));
+    #endif
+    return false;
+  }
+  if (httpCode != HTTP_CODE_OK && !_notModified) {
+    // An error message from the server, such as 401 for an invalid API key, not a forecast
+    _stats.error = OWM_ERROR_HTTP;
+    #ifdef DEBUG
+      Serial.print(F("API Call HTTP status "));
+      Serial.println(httpCode);
+    #endif
+    return false;
+  }
+  return true;
+}
+
+void OWMOneCall::setCacheTime(uint32_t current, uint32_t minutely, uint32_t hourly, uint32_t daily, uint32_t alerts) {
+  _cacheTime[0] = current;
+  _cacheTime[1] = minutely;
+  _cacheTime[2] = hourly;
+  _cacheTime[3] = daily;
+  _cacheTime[4] = alerts;
+}
+
+void OWMOneCall::clearCache() {
+  _cachedSections = 0;
+  _etag = "";
+  _etagSections = 0;
+}
+
+uint8_t OWMOneCall::staleSections() {
+  uint8_t requested = requestedSections();
+  uint8_t stale = 0;
+  unsigned long now = millis();
+
+  for (uint8_t i = 0; i < OWM_SECTIONS; i++) {
+    uint8_t section = 1 << i;
+    uint32_t age = (now - _cachedAt[i]) / 1000;
+
+    if (!(requested & section)) continue;
+    if (!(_cachedSections & section) || (age >= _cacheTime[i] && age >= _maxAge[i])) stale |= section;
+  }
+  return stale;
+}
+
+void OWMOneCall::updateCache() {
+  String etag = _transport->header("ETag");
+  String control = _transport->header("Cache-Control");
+
+  // A 304 response may leave out the ETag, which then stays the same
+  if (etag.length()) {
+    _etag = etag;
+    _etagSections = _sections;
+  }
+
+  // The server's max-age, if given, is how long the response stays current.  no-cache and
+  // no-store ask for a new request every time
+  uint32_t maxAge = 0;
+  int start = control.indexOf("max-age=");
+  if (start >= 0 && control.indexOf("no-cache") < 0 && control.indexOf("no-store") < 0) {
+    maxAge = atol(control.c_str() + start + 8);
+  }
+
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < OWM_SECTIONS; i++) {
+    if (!(_sections & (1 << i))) continue;
+    _cachedAt[i] = now;
+    _maxAge[i] = maxAge;
+  }
+  _cachedSections |= _sections;
+}
+
+void OWMOneCall::endRequest(bool parsed) {
+  // Part of a failed response may still be unread so the connection can't be used again
+  _transport->end(parsed);
+
+  if (!_measuring) return;
+  _measuring = false;
+
+  unsigned long now = millis();
+  uint32_t body = now - _bodyStart;
+  _stats.totalMs = now - _requestStart;
+  _stats.parseMs = _parseMicros / 1000;
+  _stats.transferMs = body > _stats.parseMs ? body - _stats.parseMs : 0;
+  if (!parsed && _stats.error == OWM_ERROR_NONE) _stats.error = OWM_ERROR_PARSE;
+
+  // The samples can miss the lowest point, the heap's own low-water mark does not.  It is kept
+  // since the start, so it only tells about this request when the request lowered it
+  uint32_t low = ESP.getMinFreeHeap();
+  if (low < _heapLowStart && low < _stats.freeHeap) _stats.freeHeap = low;
+
+  _stats.requests++;
+  if (!parsed) _stats.failures++;
+  if (_stats.requests == 1 || _stats.freeHeap < _stats.minFreeHeap) _stats.minFreeHeap = _stats.freeHeap;
+
+  uint8_t bucket = owmStatsBucket(_stats.totalMs);
+  if (_stats.histogram[bucket] == UINT16_MAX) {
+    for (uint8_t i = 0; i < OWM_STATS_BUCKETS; i++) _stats.histogram[i] /= 2;
+  }
+  _stats.histogram[bucket]++;
+}
+
+bool OWMOneCall::startWeather() {
+  return startPoll(false);
+}
+
+bool OWMOneCall::startWeatherAll() {
+  return startPoll(true);
+}
+
+void OWMOneCall::setPollTime(uint16_t pollTime) {
+  _pollTime = pollTime ? pollTime : 1;
+}
+
+void OWMOneCall::setCallback(OWMCallback callback) {
+  _callback = callback;
+}
+
+bool OWMOneCall::startPoll(bool all) {
+  if (_polling || !_apiPrefix) return false;
+
+  _pollAll = all;
+  _pollSlot = all ? nextLocation(-1) : -1;
+  if (all && _pollSlot < 0) return false;  // No locations added
+
+  if (!prepareStaging()) return false;
+  _pollOk = true;
+  _pollStep = POLL_REQUEST;
+  _polling = true;
+  return true;
+}
+
+// Allocate the staging forecast the first time it is needed after begin().  Returns false when
+// there is no room in the arena or the heap
+bool OWMOneCall::prepareStaging() {
+  if (!_stagingReady) _stagingReady = allocateForecast(_staging);
+  return _stagingReady;
+}
+
+int8_t OWMOneCall::nextLocation(int8_t slot) {
+  for (int8_t i = slot + 1; i < OWM_MAX_LOCATIONS; i++) {
+    if (_locations[i]) return i;
+  }
+  return -1;
+}
+
+OWMPollState OWMOneCall::poll() {
+  if (!_polling) return POLL_IDLE;
+
+  if (_pollStep == POLL_REQUEST) {
+    OWMLocation *location = _pollSlot < 0 ? NULL : _locations[_pollSlot];
+
+    _sections = location ? requestedSections() : staleSections();
+    if (!_sections) {
+      // The stored forecast is recent enough, nothing to request
+      _polling = false;
+      if (_callback) _callback(_pollSlot, true);
+      return POLL_DONE;
+    }
+
+    // The transport sends the request and reads the headers over the next poll() calls, the
+    // body is then read in slices of up to the poll time
+    const char *etag = location ? startRequest(location->latitude, location->longitude, false)
+                                : startRequest(_lat, _lon, true);
+    _transport->start(_apiCall, etag, _keepAlive, _timeout);
+    _pollStep = POLL_HEADERS;
+  } else if (_pollStep == POLL_HEADERS) {
+    OWMLocation *location = _pollSlot < 0 ? NULL : _locations[_pollSlot];
+    int httpCode = _transport->update();
+    if (httpCode == OWM_TRANSPORT_PENDING) return POLL_BUSY;
+    bool sent = checkResponse(httpCode, _pollSlot < 0);
+
+    if (sent && _notModified) {
+      finishPoll(true);
+    } else if (sent) {
+      // With double buffering the location set with setLocation() is parsed straight into the
+      // unpublished buffer, every other forecast goes through the staging buffer
+      _pollBuffer = (!location && _doubleBuffer) ? beginUpdate() : &_staging;
+      if (!location) keepSections(*_pollBuffer);
+      _wx = _pollBuffer;
+      startStream(_transport->chunked(), _transport->size());
+      _wx = this;
+      _pollStep = POLL_RECEIVE;
     } else {
-      #ifdef DEBUG
-        Serial.print(F("API Call error"));
-      #endif
-      return false;
+      finishPoll(false);
+    }
+  } else {
+    _wx = _pollBuffer;
+    StreamResult result = readStream(_transport->stream(), _pollTime);
+    _wx = this;
+    if (result != STREAM_MORE) finishPoll(result == STREAM_DONE);
+  }
+
+  if (_polling) return POLL_BUSY;
+  return _pollOk ? POLL_DONE : POLL_FAILED;
+}
+
+void OWMOneCall::finishPoll(bool parsed) {
+  if (parsed && _pollSlot < 0) updateCache();
+  endRequest(parsed);
+
+  // Publish the complete forecast by exchanging it with the staging buffer, whose arrays then
+  // hold the previous forecast and are reused for the next response
+  OWMLocation *location = _pollSlot < 0 ? NULL : _locations[_pollSlot];
+  if (location) location->updated = parsed;
+  if (_pollStep == POLL_RECEIVE && _pollBuffer != &_staging) {
+    endUpdate(_pollBuffer, parsed);
+  } else if (parsed && !_notModified) {
+    if (location) {
+      std::swap(location->forecast, _staging);
+    } else if (_pollSlot < 0) {
+      OWMForecast *wx = beginUpdate();
+      std::swap(*wx, _staging);
+      endUpdate(wx, true);
     }
-  http.end();
-  return true; 
-}
-
-Icon OWMOneCall::convertIcon(String str) {
-    if (str == "01d") return i01d;
-    else if(str == "01n") return i01n;
-    else if(str == "02d") return i02d;
-    else if(str == "02n") return i02n;
-    else if(str == "03d") return i03d;
-    else if(str == "03n") return i03n;
-    else if(str == "04d") return i04d;
-    else if(str == "04n") return i04n;
-    else if(str == "09d") return i09d;
-    else if(str == "09n") return i09n;
-    else if(str == "10d") return i10d;
-    else if(str == "10n") return i10n;
-    else if(str == "11d") return i11d;
-    else if(str == "11n") return i11n;
-    else if(str == "13d") return i13d;
-    else if(str == "13n") return i13n;
-    else if(str == "50d") return i50d;
-    else if(str == "50n") return i50n;
-    else return ierr;
+  }
+  if (!parsed) _pollOk = false;
+  if (_callback) _callback(_pollSlot, parsed);
+
+  _pollSlot = _pollAll ? nextLocation(_pollSlot) : -1;
+  if (_pollSlot < 0) _polling = false;
+  else _pollStep = POLL_REQUEST;
+}
+
+void OWMOneCall::cancelPoll() {
+  if (!_polling) return;
+  if (_pollStep == POLL_RECEIVE && _pollBuffer != &_staging) endUpdate(_pollBuffer, false);
+  _measuring = false;  // Abandoned, not a failed request
+  endRequest(false);
+  _polling = false;
+}
+
+// Conversions used by the store functions.  Values come either from the JsonDocument or as
+// text from the stream parser.  Missing or null values become 0 and fractional values are
+// truncated for integer fields
+static float toFloat(JsonVariantConst value) {
+  return value.as<float>();
+}
+
+static float toFloat(const char *value) {
+  return strtod(value, NULL);
+}
+
+static uint32_t toUInt(JsonVariantConst value) {
+  return value.as<uint32_t>();
+}
+
+static uint32_t toUInt(const char *value) {
+  double number = strtod(value, NULL);
+  return number > 0 ? (uint32_t)number : 0;
+}
+
+static const char *toText(JsonVariantConst value) {
+  return value.as<const char *>();
+}
+
+// Field of a table by its key and sub key.  The hash picks the entry, the strings confirm it
+static const OWMField *findField(const OWMField *fields, size_t count, const char *key, const char *sub) {
+  uint32_t hash = owmFieldHash(key, sub);
+  for (size_t i = 0; i < count; i++) {
+    const OWMField &field = fields[i];
+    if (field.hash != hash || strcmp(field.key, key)) continue;
+    if (field.sub ? (sub && !strcmp(field.sub, sub)) : !sub) return &field;
+  }
+  return NULL;
+}
+
+// Read and write a field of a record whatever type it is held as.  Integer fields truncate
+static float fieldFloat(const void *record, const OWMField &field) {
+  const uint8_t *p = (const uint8_t *)record + field.offset;
+  switch (field.type) {
+    case OWM_FIELD_U8: return *p;
+    case OWM_FIELD_U16: return *(const uint16_t *)p;
+    case OWM_FIELD_U32: return *(const uint32_t *)p;
+    case OWM_FIELD_FLOAT: return *(const float *)p;
+    case OWM_FIELD_CENTI: return *(const OWMCenti *)p;
+    case OWM_FIELD_CENTIU: return *(const OWMCentiU *)p;
+    default: return *(const OWMPercent *)p;
+  }
+}
+
+static uint32_t fieldUInt(const void *record, const OWMField &field) {
+  const uint8_t *p = (const uint8_t *)record + field.offset;
+  switch (field.type) {
+    case OWM_FIELD_U8: return *p;
+    case OWM_FIELD_U16: return *(const uint16_t *)p;
+    case OWM_FIELD_U32: return *(const uint32_t *)p;
+    default: return (uint32_t)fieldFloat(record, field);
+  }
+}
+
+static void setFieldFloat(void *record, const OWMField &field, float value) {
+  uint8_t *p = (uint8_t *)record + field.offset;
+  switch (field.type) {
+    case OWM_FIELD_U8: *p = (uint8_t)value; break;
+    case OWM_FIELD_U16: *(uint16_t *)p = (uint16_t)value; break;
+    case OWM_FIELD_U32: *(uint32_t *)p = (uint32_t)value; break;
+    case OWM_FIELD_FLOAT: *(float *)p = value; break;
+    case OWM_FIELD_CENTI: *(OWMCenti *)p = value; break;
+    case OWM_FIELD_CENTIU: *(OWMCentiU *)p = value; break;
+    default: *(OWMPercent *)p = value; break;
+  }
+}
+
+static void setFieldUInt(void *record, const OWMField &field, uint32_t value) {
+  uint8_t *p = (uint8_t *)record + field.offset;
+  switch (field.type) {
+    case OWM_FIELD_U8: *p = value; break;
+    case OWM_FIELD_U16: *(uint16_t *)p = value; break;
+    case OWM_FIELD_U32: *(uint32_t *)p = value; break;
+    default: setFieldFloat(record, field, value); break;
+  }
+}
+
+// Array of hourlySeries held at the offset of field
+template <typename T>
+static T *seriesArray(const hourlySeries &series, const OWMField &field) {
+  T *array;
+  memcpy(&array, (const uint8_t *)&series + field.offset, sizeof(array));
+  return array;
+}
+
+template <typename V>
+static void storeField(void *record, const OWMField *fields, size_t count, const char *key, const char *sub, V value) {
+  const OWMField *field = findField(fields, count, key, sub);
+  if (!field) return;
+  if (field->type <= OWM_FIELD_U32) setFieldUInt(record, *field, toUInt(value));
+  else setFieldFloat(record, *field, toFloat(value));
+}
+
+static const char *toText(const char *value) {
+  return value;
+}
+
+// Visit every field of a forecast entry once.  Members of nested objects (temp.morn, rain.1h)
+// and of the first weather condition are passed as key and sub.  Null values are skipped and
+// keep the cleared value, as a missing field does
+template <typename Store>
+static void visitFields(JsonVariantConst entry, Store store) {
+  for (JsonPairConst field : entry.as<JsonObjectConst>()) {
+    const char *key = field.key().c_str();
+    JsonVariantConst value = field.value();
+
+    if (value.is<JsonArrayConst>()) value = value[0];
+    if (value.is<JsonObjectConst>()) {
+      for (JsonPairConst member : value.as<JsonObjectConst>()) {
+        if (!member.value().isNull()) store(key, member.key().c_str(), member.value());
+      }
+    } else if (!value.isNull()) {
+      store(key, NULL, value);
+    }
+  }
+}
+
+template <typename Input>
+bool OWMOneCall::parseDocument(Input &input) {
+  _jsonAllocator.resetPeak();
+  JsonDocument wxData(&_jsonAllocator);
+
+  DeserializationError wxError = deserializeJson(wxData, input, DeserializationOption::Filter(_filter));
+  _jsonMemory = _jsonAllocator.peak();
+  _jsonAllocations = _jsonAllocator.allocations();
+  sampleHeap();  // The document is at its largest
+  #ifdef DEBUG
+    Serial.print(F("JSON memory used: "));
+    Serial.println(_jsonMemory);
+  #endif
+  if (wxError) {
+    #ifdef DEBUG
+      Serial.print(F("Weather data JSON error: "));
+      Serial.println(wxError.c_str());
+    #endif
+    return false;
+  }
+
+  clearForecasts(_sections);
+
+  // Walk the document once so each section, entry and field is only looked up a single time
+  for (JsonPairConst section : wxData.as<JsonObjectConst>()) {
+    const char *name = section.key().c_str();
+    JsonVariantConst value = section.value();
+    uint8_t i = 0;
+
+    if (value.isNull()) continue;
+    if (!strcmp(name, "timezone")) {
+      _wx->timeZone = toText(value);
+    }
+    else if (!strcmp(name, "timezone_offset")) {
+      _wx->timeZoneOffset = value.as<int32_t>();
+    }
+    else if (!strcmp(name, "current")) {
+      if (_currentRpt) {
+        visitFields(value, [this](const char *key, const char *sub, JsonVariantConst field) {
+          storeRecord(_wx->currWx, _currentFields, OWM_FIELD_COUNT(_currentFields), key, sub, field);
+        });
+      }
+    }
+    else if (!strcmp(name, "minutely")) {
+      for (JsonVariantConst entry : value.as<JsonArrayConst>()) {
+        if (i >= _numMinRpts) break;
+        minuteWeather &wx = _wx->minWx[i++];
+        visitFields(entry, [&wx](const char *key, const char *sub, JsonVariantConst field) {
+          storeField(&wx, _minuteFields, OWM_FIELD_COUNT(_minuteFields), key, sub, field);
+        });
+      }
+    }
+    else if (!strcmp(name, "hourly")) {
+      for (JsonVariantConst entry : value.as<JsonArrayConst>()) {
+        if (i >= _numHrRpts) break;
+        uint8_t hour = i++;
+        visitFields(entry, [this, hour](const char *key, const char *sub, JsonVariantConst field) {
+          storeHour(hour, key, sub, field);
+        });
+      }
+    }
+    else if (!strcmp(name, "daily")) {
+      for (JsonVariantConst entry : value.as<JsonArrayConst>()) {
+        if (i >= _numDlyRpts) break;
+        dailyRecord &wx = _wx->dlyWx[i++];
+        visitFields(entry, [this, &wx](const char *key, const char *sub, JsonVariantConst field) {
+          storeRecord(wx, _dayFields, OWM_FIELD_COUNT(_dayFields), key, sub, field);
+        });
+      }
+    }
+  }
+  deriveSections(*_wx, _sections);
+  return true;
+}
+
+bool OWMOneCall::parseWeather(Stream &input) {
+  if (_polling) return false;
+
+  OWMForecast *wx = beginUpdate();
+  _sections = requestedSections();
+  _wx = wx;
+  bool parsed = (_streaming || _numAlerts) ? parseStream(input) : parseDocument(input);
+  _wx = this;
+  endUpdate(wx, parsed);
+  clearCache();  // The forecast no longer matches the last API response
+  return parsed;
+}
+
+void OWMOneCall::setDoubleBuffer(bool doubleBuffer) {
+  _doubleBufferSetting = doubleBuffer;
+}
+
+const OWMForecast *OWMOneCall::getForecast() {
+  return _front.load(std::memory_order_acquire);
+}
+
+uint32_t OWMOneCall::getSequence() {
+  return _sequence.load(std::memory_order_acquire);
+}
+
+bool OWMOneCall::forecastIntact(uint32_t sequence) {
+  // Keep the reads of the forecast before the sequence check
+  std::atomic_thread_fence(std::memory_order_acquire);
+  uint32_t now = _sequence.load(std::memory_order_relaxed);
+
+  // A single forecast is overwritten as soon as the next update starts.  With double buffering
+  // the forecast published at an even sequence s is written again from s + 3, after the other
+  // buffer has been filled and published
+  if (!_doubleBuffer) return now == sequence && !(sequence & 1);
+  return (uint32_t)(now - (sequence & ~1U)) <= 2;
+}
+
+// Hours stored in wx, in records or series
+uint8_t OWMOneCall::hourCount(const OWMForecast &wx) {
+  return wx.hrWx ? _numHrRpts : wx.hrSeries.count;
+}
+
+static uint32_t hourTime(const OWMForecast &wx, uint8_t hour) {
+  return wx.hrWx ? wx.hrWx[hour].time : wx.hrSeries.time[hour];
+}
+
+static int32_t localDay(uint32_t time, int32_t offset) {
+  return (int32_t)(((int64_t)time + offset) / 86400);
+}
+
+int8_t OWMOneCall::hourAt(uint32_t time, const OWMForecast *wx) {
+  if (!wx) wx = getForecast();
+  uint8_t hours = hourCount(*wx);
+  uint32_t first = hours ? hourTime(*wx, 0) : 0;
+  if (!first || time < first) return -1;
+
+  // Entries are an hour apart, so the offset from the first gives the entry.  Should one be
+  // missing, step back to the last entry at or before time
+  uint32_t hour = (time - first) / 3600;
+  int8_t i = hour < hours ? hour : hours - 1;
+  while (i > 0 && (!hourTime(*wx, i) || hourTime(*wx, i) > time)) i--;
+  return time - hourTime(*wx, i) < 3600 ? i : -1;
+}
+
+int8_t OWMOneCall::dayAt(uint32_t time, const OWMForecast *wx) {
+  if (!wx) wx = getForecast();
+  uint32_t first = _numDlyRpts ? wx->dlyWx[0].time : 0;
+  if (!first) return -1;
+
+  int32_t day = localDay(time, wx->timeZoneOffset);
+  int32_t i = day - localDay(first, wx->timeZoneOffset);
+  if (i < 0) return -1;
+  if (i >= _numDlyRpts) i = _numDlyRpts - 1;
+  while (i > 0 && (!wx->dlyWx[i].time || localDay(wx->dlyWx[i].time, wx->timeZoneOffset) > day)) i--;
+  return localDay(wx->dlyWx[i].time, wx->timeZoneOffset) == day ? i : -1;
+}
+
+void OWMOneCall::hourPoint(const OWMForecast &wx, uint8_t hour, OWMPoint &point) {
+  if (wx.hrWx) {
+    const hourlyRecord &h = wx.hrWx[hour];
+    point.temp = h.temp;
+    point.feelsLike = h.feelsLike;
+    point.dewPoint = h.dewPoint;
+    point.pressure = h.pressure;
+    point.humidity = h.humidity;
+    point.clouds = h.clouds;
+    point.uvi = h.uvi;
+    point.windSpeed = h.windSpeed;
+    point.windGust = h.windGust;
+    point.precipProb = h.precipProb;
+    point.rain = h.rain;
+    point.snow = h.snow;
+  } else {
+    const hourlySeries &h = wx.hrSeries;
+    point.temp = h.temp[hour];
+    point.feelsLike = h.feelsLike[hour];
+    point.dewPoint = h.dewPoint[hour];
+    point.pressure = h.pressure[hour];
+    point.humidity = h.humidity[hour];
+    point.clouds = h.clouds[hour];
+    point.uvi = h.uvi[hour];
+    point.windSpeed = h.windSpeed[hour];
+    point.windGust = h.windGust[hour];
+    point.precipProb = h.precipProb[hour];
+    point.rain = h.rain[hour];
+    point.snow = h.snow[hour];
+  }
+}
+
+static float lerp(float a, float b, float f) {
+  return a + (b - a) * f;
+}
+
+bool OWMOneCall::forecastAt(uint32_t time, OWMPoint &point, const OWMForecast *wx) {
+  if (!wx) wx = getForecast();
+  point.time = time;
+
+  int8_t hour = hourAt(time, wx);
+  if (hour >= 0) {
+    uint32_t start = hourTime(*wx, hour);
+    point.hourly = true;
+    hourPoint(*wx, hour, point);
+    if (hour + 1 >= hourCount(*wx) || hourTime(*wx, hour + 1) != start + 3600) return true;
+
+    // Rain and snow are totals for each hour and are not interpolated
+    OWMPoint next;
+    float f = (time - start) / 3600.0f;
+    hourPoint(*wx, hour + 1, next);
+    point.temp = lerp(point.temp, next.temp, f);
+    point.feelsLike = lerp(point.feelsLike, next.feelsLike, f);
+    point.dewPoint = lerp(point.dewPoint, next.dewPoint, f);
+    point.pressure = lerp(point.pressure, next.pressure, f);
+    point.humidity = lerp(point.humidity, next.humidity, f);
+    point.clouds = lerp(point.clouds, next.clouds, f);
+    point.uvi = lerp(point.uvi, next.uvi, f);
+    point.windSpeed = lerp(point.windSpeed, next.windSpeed, f);
+    point.windGust = lerp(point.windGust, next.windGust, f);
+    point.precipProb = lerp(point.precipProb, next.precipProb, f);
+    return true;
+  }
+
+  int8_t day = dayAt(time, wx);
+  if (day < 0) return false;
+
+  // Temperatures through the day from the four day parts, other values for the whole day
+  const dailyRecord &d = wx->dlyWx[day];
+  float parts[] = {d.nightTemp, d.morningTemp, d.dayTemp, d.eveTemp, d.nightTemp};
+  float feels[] = {d.nightFeels, d.mornFeels, d.dayFeels, d.eveFeels, d.nightFeels};
+  uint32_t seconds = ((int64_t)time + wx->timeZoneOffset) % 86400;
+  uint8_t part = seconds / 21600;
+  float f = (seconds % 21600) / 21600.0f;
+
+  point.hourly = false;
+  point.temp = lerp(parts[part], parts[part + 1], f);
+  point.feelsLike = lerp(feels[part], feels[part + 1], f);
+  point.dewPoint = d.dewPoint;
+  point.pressure = d.pressure;
+  point.humidity = d.humidity;
+  point.clouds = d.clouds;
+  point.uvi = d.uvi;
+  point.windSpeed = d.windSpeed;
+  point.windGust = d.windGust;
+  point.precipProb = d.precipProb;
+  point.rain = (float)d.rain / 24;
+  point.snow = (float)d.snow / 24;
+  return true;
+}
+
+OWMForecast *OWMOneCall::beginUpdate() {
+  OWMForecast *front = _front.load(std::memory_order_relaxed);
+  OWMForecast *wx = !_doubleBuffer ? this : (front == this ? &_back : this);
+
+  // Odd while the forecast is written
+  _sequence.fetch_add(1, std::memory_order_acq_rel);
+  return wx;
+}
+
+void OWMOneCall::endUpdate(OWMForecast *wx, bool updated) {
+  if (updated) _front.store(wx, std::memory_order_release);
+  _sequence.fetch_add(1, std::memory_order_release);
+}
+
+bool OWMOneCall::parseStream(Stream &input, bool chunked, int32_t length) {
+  StreamResult result;
+
+  startStream(chunked, length);
+  do {
+    result = readStream(input, 0);
+  } while (result == STREAM_MORE);
+  return result == STREAM_DONE;
+}
+
+void OWMOneCall::startStream(bool chunked, int32_t length) {
+  _json.reset();
+  _lastRead = millis();
+
+  _chunked = chunked;
+  _chunkLeft = -1;
+  _chunkSize = 0;
+  _chunkExtension = false;
+  _lastChunk = false;
+  _bodyLeft = chunked ? -1 : length;
+  _bodyDone = !chunked && length <= 0;
+
+  _jsonMemory = 0;  // No JsonDocument is used
+  _jsonAllocations = 0;
+  clearForecasts(_sections);
+}
+
+OWMOneCall::StreamResult OWMOneCall::readStream(Stream &input, uint16_t budget) {
+  char buf[64];
+  unsigned long start = millis();
+
+  while (!_json.done() || !_bodyDone) {
+    if (_bodyLeft == 0) {
+      #ifdef DEBUG
+        Serial.println(F("Weather data JSON error: IncompleteInput"));
+      #endif
+      return STREAM_ERROR;  // The body ended before the JSON
+    }
+    int available = input.available();
+    if (available <= 0) {
+      if (millis() - _lastRead > _timeout) {
+        #ifdef DEBUG
+          Serial.println(F("Weather data stream timeout"));
+        #endif
+        if (_measuring) _stats.error = OWM_ERROR_TIMEOUT;
+        return STREAM_ERROR;
+      }
+      if (budget) return STREAM_MORE;  // Come back when more has arrived
+      delay(1);
+      continue;
+    }
+    if (budget && millis() - start >= budget) return STREAM_MORE;
+
+    // Nothing past the end of a Content-Length body is read, it belongs to the next response
+    if (available > (int)sizeof(buf)) available = sizeof(buf);
+    if (_bodyLeft >= 0 && available > _bodyLeft) available = _bodyLeft;
+    size_t len = input.readBytes(buf, available);
+    unsigned long parseStart = micros();
+    _lastRead = millis();
+    if (_measuring) _stats.payloadBytes += len;
+    for (size_t i = 0; i < len; i++) {
+      char c = buf[i];
+
+      // Chunked transfer encoding: each chunk is a hex size line, the data and CRLF, ending
+      // with a zero size chunk.  _chunkLeft counts the data bytes left in a chunk, -1 while
+      // reading a size line.  Reading continues to the end of the body so the connection can
+      // be reused
+      if (_chunked) {
+        if (_chunkLeft < 0) {
+          if (c == '\n') {
+            _lastChunk = !_chunkSize;
+            _chunkLeft = _chunkSize;
+            _chunkSize = 0;
+            _chunkExtension = false;
+          } else if (c == ';') {
+            _chunkExtension = true;
+          } else if (isxdigit(c) && !_chunkExtension) {
+            _chunkSize = _chunkSize * 16 + (isdigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+          }
+          continue;
+        }
+        if (_chunkLeft == 0) {
+          // CRLF after the data, or after the last chunk the end of the body
+          if (c == '\n') {
+            if (_lastChunk) _bodyDone = true;
+            _chunkLeft = -1;
+          }
+          continue;
+        }
+        _chunkLeft--;
+      } else if (_bodyLeft > 0 && --_bodyLeft == 0) {
+        // A Content-Length body is read to the end, whitespace after the JSON included, so
+        // the connection can be reused
+        _bodyDone = true;
+      }
+
+      #ifdef DEBUG1
+        Serial.write(c);
+      #endif
+      if (_json.done()) continue;  // Whitespace after the JSON
+      if (!_json.feed(c)) {
+        #ifdef DEBUG
+          Serial.println(F("Weather data JSON error: InvalidInput"));
+        #endif
+        return STREAM_ERROR;
+      }
+    }
+    _parseMicros += micros() - parseStart;
+  }
+  unsigned long parseStart = micros();
+  deriveSections(*_wx, _sections);
+  _parseMicros += micros() - parseStart;
+  sampleHeap();
+  return STREAM_DONE;
+}
+
+void OWMOneCall::clearForecasts(uint8_t sections) {
+  // Optional fields (rain, snow, gusts) are left out of the response when not forecast
+  if (_currentRpt && (sections & OWM_CURRENT)) _wx->currWx = currentWeather();
+  if (sections & OWM_MINUTELY) {
+    for (int i = 0; i < _numMinRpts; i++) _wx->minWx[i] = minuteWeather();
+  }
+  if (sections & OWM_HOURLY) {
+    if (_hourlyStorage != STORE_SERIES) {
+      for (int i = 0; i < _numHrRpts; i++) _wx->hrWx[i] = hourlyRecord();
+    }
+    if (_wx->hrSeries.count) {
+      memset(_wx->hrSeries.time, 0, _wx->hrSeries.count * sizeof(uint32_t));
+      memset(_wx->hrSeries.temp, 0, OWM_SERIES_FIELDS * _wx->hrSeries.count * sizeof(float));
+    }
+  }
+  if (sections & OWM_DAILY) {
+    for (int i = 0; i < _numDlyRpts; i++) _wx->dlyWx[i] = dailyRecord();
+  }
+  if (sections & OWM_ALERTS) {
+    for (int i = 0; i < _numAlerts; i++) {
+      alertWeather &alert = _wx->alertWx[i];
+      alert.start = 0;
+      alert.end = 0;
+      alert.sender[0] = 0;
+      alert.event[0] = 0;
+      alert.description[0] = 0;
+    }
+    _wx->alertCount = 0;
+  }
+}
+
+// Copy the sections that are not requested from the published forecast into wx, which is about
+// to be filled by a response and published in its place
+void OWMOneCall::keepSections(OWMForecast &wx) {
+  const OWMForecast *front = getForecast();
+  uint8_t keep = requestedSections() & ~_sections;
+
+  if (&wx == front || !keep) return;
+
+  if (keep & OWM_CURRENT) {
+    wx.currWx = front->currWx;
+    wx.derived.heatIndex = front->derived.heatIndex;
+    wx.derived.windChill = front->derived.windChill;
+  }
+  if (keep & OWM_MINUTELY) {
+    for (int i = 0; i < _numMinRpts; i++) wx.minWx[i] = front->minWx[i];
+    wx.derived.minutesToPrecip = front->derived.minutesToPrecip;
+    wx.derived.precipMinutes = front->derived.precipMinutes;
+  }
+  if (keep & OWM_HOURLY) {
+    if (wx.hrWx) {
+      for (int i = 0; i < _numHrRpts; i++) wx.hrWx[i] = front->hrWx[i];
+    }
+    if (wx.hrSeries.count) {
+      memcpy(wx.hrSeries.time, front->hrSeries.time, wx.hrSeries.count * sizeof(uint32_t));
+      memcpy(wx.hrSeries.temp, front->hrSeries.temp, OWM_SERIES_FIELDS * wx.hrSeries.count * sizeof(float));
+    }
+    wx.derived.precip3h = front->derived.precip3h;
+    wx.derived.precip24h = front->derived.precip24h;
+    wx.derived.high = front->derived.high;
+    wx.derived.low = front->derived.low;
+    wx.derived.highTime = front->derived.highTime;
+    wx.derived.lowTime = front->derived.lowTime;
+    wx.derived.maxPrecipProb = front->derived.maxPrecipProb;
+  }
+  if (keep & OWM_DAILY) {
+    for (int i = 0; i < _numDlyRpts; i++) wx.dlyWx[i] = front->dlyWx[i];
+    wx.derived.weekHigh = front->derived.weekHigh;
+    wx.derived.weekLow = front->derived.weekLow;
+    wx.derived.wettestDay = front->derived.wettestDay;
+  }
+  if (keep & OWM_ALERTS) {
+    size_t size = OWM_ALERT_SENDER_LEN + OWM_ALERT_EVENT_LEN + _alertTextLen;
+    memcpy(wx.alertWx[0].sender, front->alertWx[0].sender, _numAlerts * size);
+    for (int i = 0; i < _numAlerts; i++) {
+      wx.alertWx[i].start = front->alertWx[i].start;
+      wx.alertWx[i].end = front->alertWx[i].end;
+    }
+    wx.alertCount = front->alertCount;
+  }
+}
+
+// Temperatures and speeds in the requested units to and from Fahrenheit and mph for the
+// National Weather Service formulas
+static float toFahrenheit(float temp, OWMUnits units) {
+  if (units == IMPERIAL) return temp;
+  return (units == METRIC ? temp : temp - 273.15f) * 9 / 5 + 32;
+}
+
+static float fromFahrenheit(float temp, OWMUnits units) {
+  if (units == IMPERIAL) return temp;
+  float celsius = (temp - 32) * 5 / 9;
+  return units == METRIC ? celsius : celsius + 273.15f;
+}
+
+// Work out the derived values of the sections of wx just stored.  Entries missing from the
+// response have a zero time and end each scan
+void OWMOneCall::deriveSections(OWMForecast &wx, uint8_t sections) {
+  OWMDerived &derived = wx.derived;
+
+  if (sections & OWM_CURRENT) {
+    float tempF = toFahrenheit(wx.currWx.temp, _units);
+    float windMph = _units == IMPERIAL ? wx.currWx.windSpeed : wx.currWx.windSpeed * 2.23694f;
+    derived.heatIndex = fromFahrenheit(owmHeatIndex(tempF, wx.currWx.humidity), _units);
+    derived.windChill = fromFahrenheit(owmWindChill(tempF, windMph), _units);
+  }
+
+  if (sections & OWM_MINUTELY) {
+    derived.minutesToPrecip = -1;
+    derived.precipMinutes = 0;
+    for (uint8_t i = 0; i < _numMinRpts && wx.minWx[i].time; i++) {
+      if (!wx.minWx[i].precip) continue;
+      if (derived.minutesToPrecip < 0) derived.minutesToPrecip = (wx.minWx[i].time - wx.minWx[0].time) / 60;
+      derived.precipMinutes++;
+    }
+  }
+
+  if (sections & OWM_HOURLY) {
+    uint8_t hours = _numHrRpts < OWM_DERIVED_HOURS ? _numHrRpts : OWM_DERIVED_HOURS;
+
+    derived.precip3h = 0;
+    derived.precip24h = 0;
+    derived.high = 0;
+    derived.low = 0;
+    derived.highTime = 0;
+    derived.lowTime = 0;
+    derived.maxPrecipProb = 0;
+    for (uint8_t i = 0; i < hours; i++) {
+      // Either storage holds the same values
+      uint32_t time;
+      float temp, precip, precipProb;
+      if (wx.hrWx) {
+        const hourlyRecord &hour = wx.hrWx[i];
+        time = hour.time;
+        temp = hour.temp;
+        precip = (float)hour.rain + (float)hour.snow;
+        precipProb = hour.precipProb;
+      } else {
+        time = wx.hrSeries.time[i];
+        temp = wx.hrSeries.temp[i];
+        precip = wx.hrSeries.rain[i] + wx.hrSeries.snow[i];
+        precipProb = wx.hrSeries.precipProb[i];
+      }
+      if (!time) break;
+
+      if (!i || temp > derived.high) {
+        derived.high = temp;
+        derived.highTime = time;
+      }
+      if (!i || temp < derived.low) {
+        derived.low = temp;
+        derived.lowTime = time;
+      }
+      if (i < 3) derived.precip3h += precip;
+      derived.precip24h += precip;
+      if (precipProb > derived.maxPrecipProb) derived.maxPrecipProb = precipProb;
+    }
+  }
+
+  if (sections & OWM_DAILY) {
+    float wettest = 0;
+
+    derived.weekHigh = 0;
+    derived.weekLow = 0;
+    derived.wettestDay = 0;
+    for (uint8_t i = 0; i < _numDlyRpts && wx.dlyWx[i].time; i++) {
+      const dailyRecord &day = wx.dlyWx[i];
+      float precip = (float)day.rain + (float)day.snow;
+
+      if (!i || day.maxTemp > derived.weekHigh) derived.weekHigh = day.maxTemp;
+      if (!i || day.minTemp < derived.weekLow) derived.weekLow = day.minTemp;
+      if (precip > wettest) {
+        wettest = precip;
+        derived.wettestDay = i;
+      }
+    }
+  }
+}
+
+// Path of a value below an object at the given level: key is the field name and sub is
+// the member of a nested object (temp.morn, rain.1h) or of the first weather condition
+static bool fieldPath(const OWMStreamParser &json, uint8_t level, const char *&key, const char *&sub) {
+  key = json.key(level);
+  sub = NULL;
+
+  if (json.depth() == level + 1) return true;
+  if (json.depth() == level + 2 && !json.isArray(level + 1)) {
+    sub = json.key(level + 1);
+    return true;
+  }
+  if (json.depth() == level + 3 && json.index(level + 1) == 0 && !json.isArray(level + 2)) {
+    sub = json.key(level + 2);
+    return true;
+  }
+  return false;
+}
+
+void OWMOneCall::jsonValue(const OWMStreamParser &json, OWMJsonType type, const char *value) {
+  const char *section = json.key(0);
+  const char *key;
+  const char *sub;
+  int16_t i = json.index(1);
+
+  // A null is skipped like a missing field, rather than stored as the text "null"
+  if (type == JSON_NULL) return;
+
+  // Long strings arrive in pieces.  The alert text is joined up to its length, other values
+  // keep the first piece
+  bool alerts = !strcmp(section, "alerts");
+  if (json.offset() && !alerts) return;
+
+  if (json.depth() == 1) {
+    if (!strcmp(section, "timezone")) _wx->timeZone = value;
+    else if (!strcmp(section, "timezone_offset")) _wx->timeZoneOffset = atol(value);
+  }
+  else if (!strcmp(section, "current")) {
+    if (_currentRpt && fieldPath(json, 1, key, sub)) {
+      storeRecord(_wx->currWx, _currentFields, OWM_FIELD_COUNT(_currentFields), key, sub, value);
+    }
+  }
+  else if (!strcmp(section, "minutely")) {
+    if (i >= 0 && i < _numMinRpts && fieldPath(json, 2, key, sub)) {
+      storeField(&_wx->minWx[i], _minuteFields, OWM_FIELD_COUNT(_minuteFields), key, sub, value);
+    }
+  }
+  else if (!strcmp(section, "hourly")) {
+    if (i >= 0 && i < _numHrRpts && fieldPath(json, 2, key, sub)) storeHour(i, key, sub, value);
+  }
+  else if (!strcmp(section, "daily")) {
+    if (i >= 0 && i < _numDlyRpts && fieldPath(json, 2, key, sub)) {
+      storeRecord(_wx->dlyWx[i], _dayFields, OWM_FIELD_COUNT(_dayFields), key, sub, value);
+    }
+  }
+  else if (alerts) {
+    if (i >= 0 && i < _numAlerts && json.depth() == 3) storeAlert(i, json.key(2), value, json.offset() > 0);
+  }
+}
+
+template <typename T>
+static void storeMain(T &wx, const char *text) {
+  wx.main = owmConditionMain(wx.id, text);
+}
+
+template <typename T>
+static void storeDescription(T &wx, const char *text) {
+  wx.description = owmConditionDescription(wx.id, text);
+}
+
+#ifdef OWM_PACKED_FORECAST
+// Packed records only keep the condition ID, main and description come from the condition table
+static void storeMain(packedHourlyWeather &, const char *) {}
+static void storeDescription(packedHourlyWeather &, const char *) {}
+static void storeMain(packedDailyWeather &, const char *) {}
+static void storeDescription(packedDailyWeather &, const char *) {}
+#endif
+
+// Fields of the first entry in the weather array, common to every section
+template <typename T, typename V>
+void OWMOneCall::storeCondition(T &wx, const char *sub, V value) {
+  const OWMKey *key = findKey(_conditionKeys, OWM_FIELD_COUNT(_conditionKeys), sub);
+  if (!key) return;
+
+  switch (key->kind) {
+    case CONDITION_ID: wx.id = toUInt(value); break;
+    case CONDITION_MAIN: storeMain(wx, toText(value)); break;
+    case CONDITION_DESCRIPTION: storeDescription(wx, toText(value)); break;
+    case CONDITION_ICON: wx.ico = convertIcon(toText(value)); break;
+  }
+}
+
+template <typename T, typename V>
+void OWMOneCall::storeRecord(T &wx, const OWMField *fields, size_t count, const char *key, const char *sub, V value) {
+  if (sub && !strcmp(key, "weather")) storeCondition(wx, sub, value);
+  else storeField(&wx, fields, count, key, sub, value);
+}
+
+// An hour goes to the records, the series or both
+template <typename V>
+void OWMOneCall::storeHour(uint8_t i, const char *key, const char *sub, V value) {
+  if (_hourlyStorage != STORE_SERIES) storeRecord(_wx->hrWx[i], _hourFields, OWM_FIELD_COUNT(_hourFields), key, sub, value);
+  if (_hourlyStorage == STORE_RECORDS) return;
+
+  const OWMField *field = findField(_seriesFields, OWM_FIELD_COUNT(_seriesFields), key, sub);
+  if (!field) return;
+  if (field->type == OWM_FIELD_U32) seriesArray<uint32_t>(_wx->hrSeries, *field)[i] = toUInt(value);
+  else seriesArray<float>(_wx->hrSeries, *field)[i] = toFloat(value);
+}
+
+// Copy text into a field of size bytes, or add it to the end for the later pieces of a long
+// string.  Text that does not fit is dropped
+static void storeText(char *field, size_t size, const char *text, bool append) {
+  if (!append) field[0] = 0;
+  if (text) strlcat(field, text, size);
+}
+
+template <typename V>
+void OWMOneCall::storeAlert(uint8_t i, const char *key, V value, bool append) {
+  alertWeather &wx = _wx->alertWx[i];
+
+  if (i >= _wx->alertCount) _wx->alertCount = i + 1;
+  const OWMKey *found = findKey(_alertKeys, OWM_FIELD_COUNT(_alertKeys), key);
+  if (!found) return;
+
+  switch (found->kind) {
+    case ALERT_START: wx.start = toUInt(value); break;
+    case ALERT_END: wx.end = toUInt(value); break;
+    case ALERT_SENDER: storeText(wx.sender, OWM_ALERT_SENDER_LEN, toText(value), append); break;
+    case ALERT_EVENT: storeText(wx.event, OWM_ALERT_EVENT_LEN, toText(value), append); break;
+    case ALERT_DESCRIPTION: storeText(wx.description, _alertTextLen, toText(value), append); break;
+  }
+}
+
+// Compact encoding of the records, see OWMCodec.h.  The order of the fields is part of the
+// format, so changes need a new OWM_CODEC_VERSION.  Timestamps are written as the difference
+// from the previous entry less the expected step, the arithmetic wraps so any value round trips
+static void encodeTime(OWMEncoder &enc, uint32_t time, uint32_t &last, uint32_t step) {
+  enc.svar((int32_t)(time - last - step));
+  last = time;
+}
+
+static uint32_t decodeTime(OWMDecoder &dec, uint32_t &last, uint32_t step) {
+  last += step + (uint32_t)dec.svar();
+  return last;
+}
+
+// Condition as its position in the table, IDs not in the table follow in full
+template <typename T>
+static void encodeCondition(OWMEncoder &enc, const T &wx) {
+  uint8_t index = owmConditionIndex(wx.id);
+  enc.byte(index);
+  if (index == OWM_CONDITION_UNKNOWN) enc.uvar(wx.id);
+  enc.byte((Icon)wx.ico);
+}
+
+template <typename T>
+static void decodeCondition(OWMDecoder &dec, T &wx) {
+  uint8_t index = dec.byte();
+  const OWMCondition *condition = owmConditionAt(index);
+  wx.id = condition ? condition->id : (index == OWM_CONDITION_UNKNOWN ? dec.uvar() : 0);
+  wx.ico = (Icon)dec.byte();
+  storeMain(wx, NULL);
+  storeDescription(wx, NULL);
+}
+
+// Fields of a record in table order.  Entry timestamps are step after the one before, the
+// other timestamps are written relative to the entry or the timestamp before them
+static void encodeFields(OWMEncoder &enc, const OWMField *fields, size_t count, const void *record,
+                         uint32_t &last, uint32_t step) {
+  uint32_t time = 0, prev = 0;
+  for (size_t i = 0; i < count; i++) {
+    const OWMField &field = fields[i];
+    uint32_t value = fieldUInt(record, field);
+    switch (field.codec) {
+      case OWM_CODEC_TIME: encodeTime(enc, value, last, step); time = value; break;
+      case OWM_CODEC_FROM_TIME: enc.svar((int32_t)(value - time)); break;
+      case OWM_CODEC_FROM_PREV: enc.svar((int32_t)(value - prev)); break;
+      case OWM_CODEC_UVAR: enc.uvar(value); break;
+      case OWM_CODEC_BYTE: enc.byte(value); break;
+      case OWM_CODEC_CENTI: enc.centi(fieldFloat(record, field)); break;
+      case OWM_CODEC_PERCENT: enc.percent(fieldFloat(record, field)); break;
+      default: break;
+    }
+    prev = value;
+  }
+}
+
+static void decodeFields(OWMDecoder &dec, const OWMField *fields, size_t count, void *record,
+                         uint32_t &last, uint32_t step) {
+  uint32_t time = 0, prev = 0;
+  for (size_t i = 0; i < count; i++) {
+    const OWMField &field = fields[i];
+    switch (field.codec) {
+      case OWM_CODEC_TIME: setFieldUInt(record, field, time = decodeTime(dec, last, step)); break;
+      case OWM_CODEC_FROM_TIME: setFieldUInt(record, field, time + dec.svar()); break;
+      case OWM_CODEC_FROM_PREV: setFieldUInt(record, field, prev + dec.svar()); break;
+      case OWM_CODEC_UVAR: setFieldUInt(record, field, dec.uvar()); break;
+      case OWM_CODEC_BYTE: setFieldUInt(record, field, dec.byte()); break;
+      case OWM_CODEC_CENTI: setFieldFloat(record, field, dec.centi()); break;
+      case OWM_CODEC_PERCENT: setFieldFloat(record, field, dec.percent()); break;
+      default: break;
+    }
+    prev = fieldUInt(record, field);
+  }
+}
+
+static void encodeRecord(OWMEncoder &enc, const currentWeather &wx) {
+  uint32_t last = 0;
+  encodeFields(enc, _currentFields, OWM_FIELD_COUNT(_currentFields), &wx, last, 0);
+  encodeCondition(enc, wx);
+}
+
+static void decodeRecord(OWMDecoder &dec, currentWeather &wx) {
+  uint32_t last = 0;
+  decodeFields(dec, _currentFields, OWM_FIELD_COUNT(_currentFields), &wx, last, 0);
+  decodeCondition(dec, wx);
+}
+
+static void encodeRecord(OWMEncoder &enc, const minuteWeather &wx, uint32_t &last) {
+  encodeFields(enc, _minuteFields, OWM_FIELD_COUNT(_minuteFields), &wx, last, 60);
+}
+
+static void decodeRecord(OWMDecoder &dec, minuteWeather &wx, uint32_t &last) {
+  decodeFields(dec, _minuteFields, OWM_FIELD_COUNT(_minuteFields), &wx, last, 60);
+}
+
+static void encodeHour(OWMEncoder &enc, const hourlyRecord &wx, uint32_t &last) {
+  encodeFields(enc, _hourFields, OWM_FIELD_COUNT(_hourFields), &wx, last, 3600);
+  encodeCondition(enc, wx);
+}
+
+static void decodeHour(OWMDecoder &dec, hourlyRecord &wx, uint32_t &last) {
+  decodeFields(dec, _hourFields, OWM_FIELD_COUNT(_hourFields), &wx, last, 3600);
+  decodeCondition(dec, wx);
+}
+
+static void encodeDay(OWMEncoder &enc, const dailyRecord &wx, uint32_t &last) {
+  encodeFields(enc, _dayFields, OWM_FIELD_COUNT(_dayFields), &wx, last, 86400);
+  encodeCondition(enc, wx);
+}
+
+static void decodeDay(OWMDecoder &dec, dailyRecord &wx, uint32_t &last) {
+  decodeFields(dec, _dayFields, OWM_FIELD_COUNT(_dayFields), &wx, last, 86400);
+  decodeCondition(dec, wx);
+}
+
+// Hourly values held only as series are encoded as records without the weather condition.
+// The series fields are matched to the record fields by their keys
+static void recordFromSeries(hourlyRecord &wx, const hourlySeries &series, uint8_t i) {
+  for (const OWMField &field : _seriesFields) {
+    const OWMField *hour = findField(_hourFields, OWM_FIELD_COUNT(_hourFields), field.key, field.sub);
+    if (field.type == OWM_FIELD_U32) setFieldUInt(&wx, *hour, seriesArray<uint32_t>(series, field)[i]);
+    else setFieldFloat(&wx, *hour, seriesArray<float>(series, field)[i]);
+  }
+}
+
+static void seriesFromRecord(hourlySeries &series, uint8_t i, const hourlyRecord &wx) {
+  for (const OWMField &field : _seriesFields) {
+    const OWMField *hour = findField(_hourFields, OWM_FIELD_COUNT(_hourFields), field.key, field.sub);
+    if (field.type == OWM_FIELD_U32) seriesArray<uint32_t>(series, field)[i] = fieldUInt(&wx, *hour);
+    else seriesArray<float>(series, field)[i] = fieldFloat(&wx, *hour);
+  }
+}
+
+void OWMOneCall::encodeTo(OWMEncoder &enc) {
+  const OWMForecast *wx = getForecast();
+  uint32_t last = 0;
+  uint8_t sections = requestedSections() & ~OWM_ALERTS;  // Alerts are not encoded
+
+  enc.byte(OWM_CODEC_VERSION);
+  enc.byte(_units);
+  enc.svar(wx->timeZoneOffset);
+  enc.text(wx->timeZone.c_str());
+  enc.byte(sections);
+
+  if (_currentRpt) encodeRecord(enc, wx->currWx);
+
+  if (_numMinRpts) {
+    enc.byte(_numMinRpts);
+    for (uint8_t i = 0; i < _numMinRpts; i++) encodeRecord(enc, wx->minWx[i], last);
+  }
+
+  if (_numHrRpts) {
+    last = 0;
+    enc.byte(_numHrRpts);
+    for (uint8_t i = 0; i < _numHrRpts; i++) {
+      if (wx->hrWx) {
+        encodeHour(enc, wx->hrWx[i], last);
+      } else {
+        hourlyRecord hour = hourlyRecord();
+        recordFromSeries(hour, wx->hrSeries, i);
+        encodeHour(enc, hour, last);
+      }
+    }
+  }
+
+  if (_numDlyRpts) {
+    last = 0;
+    enc.byte(_numDlyRpts);
+    for (uint8_t i = 0; i < _numDlyRpts; i++) encodeDay(enc, wx->dlyWx[i], last);
+  }
+}
+
+bool OWMOneCall::decodeFrom(OWMDecoder &dec) {
+  if (dec.byte() != OWM_CODEC_VERSION || dec.byte() != _units) return false;
+
+  // The data is decoded into a forecast that is not on show and published once it has all
+  // been read, so truncated or corrupt data leaves the forecast as it was.  Without double
+  // buffering that is the staging forecast also used by poll()
+  OWMForecast *wx;
+  if (_doubleBuffer) {
+    wx = beginUpdate();
+  } else if (prepareStaging()) {
+    wx = &_staging;
+  } else {
+    return false;
+  }
+  char timeZone[OWM_JSON_VALUE_LEN];
+  uint32_t last = 0;
+
+  _wx = wx;
+  clearForecasts(requestedSections());
+  _wx = this;
+
+  wx->timeZoneOffset = dec.svar();
+  dec.text(timeZone, sizeof(timeZone));
+  wx->timeZone = timeZone;
+  uint8_t sections = dec.byte();
+
+  // Entries beyond the counts set in begin() are read and dropped
+  if (sections & OWM_CURRENT) {
+    currentWeather current;
+    decodeRecord(dec, current);
+    if (_currentRpt) wx->currWx = current;
+  }
+
+  if (sections & OWM_MINUTELY) {
+    uint8_t count = dec.byte();
+    for (uint8_t i = 0; i < count && dec.ok(); i++) {
+      minuteWeather minute;
+      decodeRecord(dec, minute, last);
+      if (i < _numMinRpts) wx->minWx[i] = minute;
+    }
+  }
+
+  if (sections & OWM_HOURLY) {
+    uint8_t count = dec.byte();
+    last = 0;
+    for (uint8_t i = 0; i < count && dec.ok(); i++) {
+      hourlyRecord hour = hourlyRecord();
+      decodeHour(dec, hour, last);
+      if (i >= _numHrRpts) continue;
+      if (wx->hrWx) wx->hrWx[i] = hour;
+      if (wx->hrSeries.count) seriesFromRecord(wx->hrSeries, i, hour);
+    }
+  }
+
+  if (sections & OWM_DAILY) {
+    uint8_t count = dec.byte();
+    last = 0;
+    for (uint8_t i = 0; i < count && dec.ok(); i++) {
+      dailyRecord day = dailyRecord();
+      decodeDay(dec, day, last);
+      if (i < _numDlyRpts) wx->dlyWx[i] = day;
+    }
+  }
+
+  bool ok = dec.ok();
+  if (ok) deriveSections(*wx, requestedSections());
+  if (_doubleBuffer) {
+    endUpdate(wx, ok);
+  } else if (ok) {
+    OWMForecast *front = beginUpdate();
+    std::swap(*front, _staging);
+    endUpdate(front, true);
+  }
+  return ok;
+}
+
+size_t OWMOneCall::encodeForecast(uint8_t *buf, size_t size) {
+  OWMEncoder enc(buf, size);
+  encodeTo(enc);
+  if (!buf) return enc.length();
+  return enc.ok() ? enc.length() : 0;
+}
+
+bool OWMOneCall::decodeForecast(const uint8_t *data, size_t len) {
+  if (_polling) return false;
+
+  OWMDecoder dec(data, len);
+  return decodeFrom(dec);
+}
+
+// A snapshot is a short header identifying the location followed by the encoded forecast
+static const char _snapshotMagic[4] = {'O', 'W', 'M', 'S'};
+static const uint8_t _snapshotVersion = 2;
+
+bool OWMOneCall::saveSnapshot(Print &out) {
+  OWMEncoder enc(out);
+
+  for (uint8_t i = 0; i < sizeof(_snapshotMagic); i++) enc.byte(_snapshotMagic[i]);
+  enc.byte(_snapshotVersion);
+  enc.centi(_lat);
+  enc.centi(_lon);
+  enc.text(_etag.c_str());
+  encodeTo(enc);
+  return enc.ok();
+}
+
+bool OWMOneCall::loadSnapshot(Stream &in) {
+  OWMDecoder dec(in);
+  char etag[OWM_JSON_VALUE_LEN];
+  bool match = true;
+
+  if (_polling) return false;
+
+  for (uint8_t i = 0; i < sizeof(_snapshotMagic); i++) match = (dec.byte() == _snapshotMagic[i]) && match;
+  match = (dec.byte() == _snapshotVersion) && match;
+
+  // The location is compared as it was stored, in hundredths of a degree
+  match = dec.centi() == roundf(_lat * 100) / 100.0f && match;
+  match = dec.centi() == roundf(_lon * 100) / 100.0f && match;
+  dec.text(etag, sizeof(etag));
+  if (!match || !dec.ok()) {
+    #ifdef DEBUG
+      Serial.println(F("Snapshot is not for this location"));
+    #endif
+    return false;
+  }
+
+  bool ok = decodeFrom(dec);
+
+  // The age of the snapshot is unknown so it is not fresh, but the ETag lets the next request
+  // return 304 Not Modified if the forecast has not changed
+  if (ok) {
+    clearCache();
+    _etag = etag;
+    _etagSections = requestedSections();
+  }
+  return ok;
+}
+
+// Every block is prefixed with its size so the bytes in use can be tracked when it is freed
+union OWMBlockHeader {
+  size_t size;
+  double align;
+};
+
+void *OWMJsonAllocator::allocate(size_t size) {
+  OWMBlockHeader *block = (OWMBlockHeader *)malloc(sizeof(OWMBlockHeader) + size);
+  if (!block) return NULL;
+  block->size = size;
+  track(size, 0);
+  _allocations++;
+  return block + 1;
+}
+
+void OWMJsonAllocator::deallocate(void *ptr) {
+  if (!ptr) return;
+  OWMBlockHeader *block = (OWMBlockHeader *)ptr - 1;
+  track(0, block->size);
+  free(block);
+}
+
+void *OWMJsonAllocator::reallocate(void *ptr, size_t new_size) {
+  if (!ptr) return allocate(new_size);
+  OWMBlockHeader *block = (OWMBlockHeader *)ptr - 1;
+  size_t oldSize = block->size;
+  block = (OWMBlockHeader *)realloc(block, sizeof(OWMBlockHeader) + new_size);
+  if (!block) return NULL;
+  block->size = new_size;
+  track(new_size, oldSize);
+  _allocations++;
+  return block + 1;
+}
+
+void OWMJsonAllocator::track(size_t added, size_t removed) {
+  _used = _used + added - removed;
+  if (_used > _peak) _peak = _used;
+}
+
+// Day icon for each icon number 00 - 50, ierr for numbers not used.  The night icon follows it
+static const uint8_t _iconTable[51] = {
+  ierr, i01d, i02d, i03d, i04d, ierr, ierr, ierr, ierr, i09d,  // 00 - 09
+  i10d, i11d, ierr, i13d, ierr, ierr, ierr, ierr, ierr, ierr,  // 10 - 19
+  ierr, ierr, ierr, ierr, ierr, ierr, ierr, ierr, ierr, ierr,  // 20 - 29
+  ierr, ierr, ierr, ierr, ierr, ierr, ierr, ierr, ierr, ierr,  // 30 - 39
+  ierr, ierr, ierr, ierr, ierr, ierr, ierr, ierr, ierr, ierr,  // 40 - 49
+  i50d                                                         // 50
+};
+
+// The icon name is two digits and d or n, so it is looked up directly instead of compared
+Icon OWMOneCall::convertIcon(const char *str) {
+    if (!str || !isdigit(str[0]) || !isdigit(str[1]) || !str[2] || str[3]) return ierr;
+
+    uint8_t number = (str[0] - '0') * 10 + (str[1] - '0');
+    if (number > 50 || _iconTable[number] == ierr) return ierr;
+
+    if (str[2] == 'd') return (Icon)_iconTable[number];
+    if (str[2] == 'n') return (Icon)(_iconTable[number] + 1);
+    return ierr;
 }
 
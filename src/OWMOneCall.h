@@ -6,7 +6,7 @@
   and daily forecasts for 8 days.  Utilizes ArduinoJson (https://arduinojson.org) to process the API return
   and populate data structures
 
-  Alerts reports are not implemented
+  Alerts are stored up to the count and text length set with setAlerts()
   
   Released under the MIT License
   
@@ -34,8 +34,18 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
-#include <HTTPClient.h>
 #include "math.h"
+#include <utility>
+#include <atomic>
+#include "OWMStreamParser.h"
+#include "OWMConditions.h"
+#include "OWMPacked.h"
+#include "OWMSeries.h"
+#include "OWMCodec.h"
+#include "OWMDerived.h"
+#include "OWMStats.h"
+#include "OWMFields.h"
+#include "OWMTransport.h"
 
 
 /* Enumeration for the OpenWeatherMap icons: 
@@ -87,18 +97,18 @@ struct currentWeather {
   float windSpeed;     // Wind Speed
   float windGust;      // Wind Gust
   uint16_t windDir;    // Wind direction in degrees
-  uint16_t rain;       // Rain volume for last hour in mm
-  uint16_t snow;       // Snoe volume for last hour in mm
+  float rain;          // Rain volume for last hour in mm
+  float snow;          // Snow volume for last hour in mm
   uint16_t id;         // WeatherID
-  String main;         // Open Weather Main parameter
-  String description;  // Open Weather condition
+  const char *main = "";         // Open Weather Main parameter
+  const char *description = "";  // Open Weather condition
   Icon ico ;           // Weather icon
 };
 
 // Structure for the minute by minute forecast values returned from the API
 struct minuteWeather {
   uint32_t time;   // Unix timestamp
-  uint32_t precip; // Precipitation in mm
+  float precip;    // Precipitation in mm/h
 };
 
 // Structure for the hourly forecast values returned from the API
@@ -116,11 +126,11 @@ struct hourlyWeather {
   float windGust;      // Wind Gust
   uint16_t windDir;    // Wind direction in degrees
   float precipProb;    // Probability of precipitation 0 - 1
-  uint16_t rain;       // Rain volume for last hour in mm
-  uint16_t snow;       // Snow volume for last hour in mm
+  float rain;          // Rain volume for last hour in mm
+  float snow;          // Snow volume for last hour in mm
   uint16_t id;         // WeatherID
-  String main;         // Open Weather Main parameter
-  String description;  // Open Weather condition
+  const char *main = "";         // Open Weather Main parameter
+  const char *description = "";  // Open Weather condition
   Icon ico ;           // Weather icon
 };
 
@@ -154,15 +164,222 @@ struct dailyWeather {
   float rain;       // Rain volume in mm
   float snow;       // Snow volume in mm
   uint16_t id;         // WeatherID
-  String main;         // Open Weather Main parameter
-  String description;  // Open Weather condition
+  const char *main = "";         // Open Weather Main parameter
+  const char *description = "";  // Open Weather condition
   Icon ico ;           // Weather icon
 };
 
-class OWMOneCall
+// Longest alert sender name and event name kept, including the terminator
+#ifndef OWM_ALERT_SENDER_LEN
+#define OWM_ALERT_SENDER_LEN 48
+#endif
+#ifndef OWM_ALERT_EVENT_LEN
+#define OWM_ALERT_EVENT_LEN 48
+#endif
+
+// Weather alert from a national warning system.  The text is held in memory set aside by
+// begin() and truncated to fit
+struct alertWeather {
+  uint32_t start;      // Unix timestamp
+  uint32_t end;        // Unix timestamp
+  char *sender;        // Name of the alert source
+  char *event;         // Alert event name
+  char *description;   // Full alert text, up to the length set with setAlerts()
+};
+
+/* Packed forecast records
+   Same fields and units as hourlyWeather and dailyWeather in about half the memory: values are
+   stored as fixed point hundredths, percentages in one byte and the weather condition as its
+   position in the condition table.  Fields are read and written as usual, main and description
+   share the condition byte and read as the const char * text from the condition table.  An ID
+   that is not in the table reads back as OWM_CONDITION_ID_UNKNOWN with empty text.
+   Enable with the build flag OWM_PACKED_FORECAST (for PlatformIO: build_flags = -DOWM_PACKED_FORECAST)
+*/
+struct packedHourlyWeather {
+  uint32_t time;          // Unix timestamp
+  OWMCenti temp;          // Current temperature
+  OWMCenti feelsLike;     // Human perception of temperature
+  OWMCenti dewPoint;      // Dew Point
+  OWMCenti uvi;           // UV index
+  OWMCenti windSpeed;     // Wind Speed
+  OWMCenti windGust;      // Wind Gust
+  uint16_t pressure;      // Pressure hPa
+  uint16_t visibility;    // Visibility in meters
+  uint16_t windDir;       // Wind direction in degrees
+  OWMCentiU rain;         // Rain volume for last hour in mm
+  OWMCentiU snow;         // Snow volume for last hour in mm
+  uint8_t humidity;       // Humidity %
+  uint8_t clouds;         // Cloudiness %
+  OWMPercent precipProb;  // Probability of precipitation 0 - 1
+  union {
+    OWMPackedId id;                    // WeatherID
+    OWMPackedMain main;                // Open Weather Main parameter
+    OWMPackedDescription description;  // Open Weather condition
+  };
+  OWMPackedEnum<Icon> ico;  // Weather icon
+};
+
+struct packedDailyWeather {
+  uint32_t time;          // Unix timestamp
+  uint32_t sunrise;       // Unix timestamp
+  uint32_t sunset;        // Unix timestamp
+  uint32_t moonrise;      // Unix timestamp
+  uint32_t moonset;       // Unix timestamp
+  OWMCenti morningTemp;   // Morning temperature
+  OWMCenti dayTemp;       // Day temperature
+  OWMCenti eveTemp;       // Evening temperature
+  OWMCenti nightTemp;     // Night temperature
+  OWMCenti maxTemp;       // Max daily temperature
+  OWMCenti minTemp;       // Min daily temperature
+  OWMCenti mornFeels;     // Morning feels like temperature
+  OWMCenti dayFeels;      // Day feels like temperature
+  OWMCenti eveFeels;      // Evening feels like temperature
+  OWMCenti nightFeels;    // Night feels like temperature
+  OWMCenti dewPoint;      // Dew Point
+  OWMCenti uvi;           // UV index
+  OWMCenti windSpeed;     // Wind Speed
+  OWMCenti windGust;      // Wind Gust
+  OWMCentiU rain;         // Rain volume in mm
+  OWMCentiU snow;         // Snow volume in mm
+  uint16_t pressure;      // Pressure hPa
+  uint16_t windDir;       // Wind direction in degrees
+  uint8_t humidity;       // Humidity %
+  uint8_t clouds;         // Cloudiness %
+  OWMPercent moonPhase;   // 0 and 1 are new moon; .5 is full
+  OWMPercent precipProb;  // Probability of precipitation 0 - 1
+  union {
+    OWMPackedId id;                    // WeatherID
+    OWMPackedMain main;                // Open Weather Main parameter
+    OWMPackedDescription description;  // Open Weather condition
+  };
+  OWMPackedEnum<Icon> ico;  // Weather icon
+};
+
+// Record types used for the hourly and daily forecast arrays
+#ifdef OWM_PACKED_FORECAST
+typedef packedHourlyWeather hourlyRecord;
+typedef packedDailyWeather dailyRecord;
+#else
+typedef hourlyWeather hourlyRecord;
+typedef dailyWeather dailyRecord;
+#endif
+
+// Forecast data from one API call
+struct OWMForecast {
+    // Minute, Hour, and Daily are pointers to dynamically set size based on user quantity filter
+    // Hour and Daily hold packed records when built with OWM_PACKED_FORECAST
+    currentWeather currWx = currentWeather();
+    minuteWeather *minWx = NULL;
+    hourlyRecord *hrWx = NULL;
+    dailyRecord *dlyWx = NULL;
+    hourlySeries hrSeries = hourlySeries();  // Hourly values as one array per field, see setHourlyStorage()
+    alertWeather *alertWx = NULL;  // Alerts in the last response, alertCount of them
+    uint8_t alertCount = 0;
+    OWMDerived derived = OWMDerived();  // Worked out from the sections as they are stored
+    String timeZone;
+    int32_t timeZoneOffset = 0;
+};
+
+// Maximum number of locations added with addLocation()
+#ifndef OWM_MAX_LOCATIONS
+#define OWM_MAX_LOCATIONS 10
+#endif
+
+// A location refreshed by getWeatherAll() and its forecast
+struct OWMLocation {
+    float latitude;
+    float longitude;
+    bool updated;  // true when the last getWeatherAll() call stored a forecast
+    OWMForecast forecast;
+};
+
+// Forecast values at a point in time, from forecastAt()
+struct OWMPoint {
+    uint32_t time;      // Unix timestamp asked for
+    bool hourly;        // From the hourly forecast, false when from the daily forecast
+    float temp;         // Temperature
+    float feelsLike;    // Human perception of temperature
+    float dewPoint;     // Dew Point
+    float pressure;     // Pressure hPa
+    float humidity;     // Humidity %
+    float clouds;       // Cloudiness %
+    float uvi;          // UV index
+    float windSpeed;    // Wind Speed
+    float windGust;     // Wind Gust
+    float precipProb;   // Probability of precipitation 0 - 1
+    float rain;         // Rain volume for the hour in mm
+    float snow;         // Snow volume for the hour in mm
+};
+
+// Size of the buffer holding the API call, including the API key
+#ifndef OWM_API_CALL_SIZE
+#define OWM_API_CALL_SIZE 192
+#endif
+
+// Sections of the forecast, combined as bit flags
+#define OWM_CURRENT 0x01
+#define OWM_MINUTELY 0x02
+#define OWM_HOURLY 0x04
+#define OWM_DAILY 0x08
+#define OWM_ALERTS 0x10
+#define OWM_SECTIONS 5
+
+// Arena sizes for setArena() and OWMStaticOneCall.  Every array starts on an 8 byte boundary
+#define OWM_ARENA_ALIGN(size) (((size) + 7) & ~(size_t)7)
+
+// One forecast with min minutes, hr hours and dly days, plus OWM_SERIES_SIZE(hr) with hourly
+// series storage and OWM_ALERTS_SIZE(count, textLength) with alerts
+#define OWM_FORECAST_SIZE(min, hr, dly) (OWM_ARENA_ALIGN((min) * sizeof(minuteWeather)) + \
+  OWM_ARENA_ALIGN((hr) * sizeof(hourlyRecord)) + OWM_ARENA_ALIGN((dly) * sizeof(dailyRecord)))
+#define OWM_SERIES_SIZE(hr) (OWM_ARENA_ALIGN((hr) * sizeof(uint32_t)) + \
+  OWM_ARENA_ALIGN(OWM_SERIES_FIELDS * (hr) * sizeof(float)))
+#define OWM_ALERTS_SIZE(count, textLength) (OWM_ARENA_ALIGN((count) * sizeof(alertWeather)) + \
+  OWM_ARENA_ALIGN((count) * (OWM_ALERT_SENDER_LEN + OWM_ALERT_EVENT_LEN + (textLength) + 1)))
+
+// Each location added with addLocation(), on top of its forecast
+#define OWM_LOCATION_SIZE OWM_ARENA_ALIGN(sizeof(OWMLocation))
+
+#if OWM_MAX_LOCATIONS > 32
+#error "OWM_MAX_LOCATIONS can be at most 32"
+#endif
+
+// Progress of a request started with startWeather() or startWeatherAll(), returned by poll()
+enum OWMPollState {
+  POLL_IDLE,    // No request started
+  POLL_BUSY,    // Request in progress, keep calling poll()
+  POLL_DONE,    // Finished and every forecast was updated
+  POLL_FAILED   // Finished and at least one forecast was not updated
+};
+
+// Called by poll() as each forecast is finished.  slot is the location from addLocation(), or
+// -1 for the location set with setLocation()
+typedef void (*OWMCallback)(int8_t slot, bool updated);
+
+// ArduinoJson allocator that keeps track of the memory used by a JsonDocument
+class OWMJsonAllocator : public ArduinoJson::Allocator
+{
+private:
+    size_t _used;  // Bytes currently allocated
+    size_t _peak;  // Most bytes allocated at once since the last resetPeak()
+    uint32_t _allocations;  // Calls to allocate() and reallocate() since the last resetPeak()
+    void track(size_t added, size_t removed);
+
+public:
+    OWMJsonAllocator() : _used(0), _peak(0), _allocations(0) {}
+    void *allocate(size_t size) override;
+    void deallocate(void *ptr) override;
+    void *reallocate(void *ptr, size_t new_size) override;
+
+    size_t used() const { return _used; }
+    size_t peak() const { return _peak; }
+    uint32_t allocations() const { return _allocations; }
+    void resetPeak() { _peak = _used; _allocations = 0; }
+};
+
+// The forecast for the location set with setLocation() is in the inherited OWMForecast members
+class OWMOneCall : public OWMForecast, private OWMStreamHandler
 {
 private:
-    String _apiKey;  // User's API Key required to make the call
     OWMUnits _units;  // Requested units for the call to be returned in
 
     // Latitute and longiture to check the weather for
@@ -185,6 +402,43 @@ private:
     uint8_t _numHrRpts;
     uint8_t _numDlyRpts;
 
+    // Hourly forecast in records, series or both, as set with setHourlyStorage() and as
+    // applied by begin() when it allocated the forecasts
+    OWMStorage _storageSetting;
+    OWMStorage _hourlyStorage;
+
+    // Most alerts stored and the length of their description including the terminator, as set
+    // with setAlerts() and as applied by begin().  The length with the terminator is held in 32
+    // bits, as the longest text setAlerts() takes leaves no room for it in 16
+    uint8_t _maxAlerts;
+    uint16_t _maxAlertText;
+    uint8_t _numAlerts;
+    uint32_t _alertTextLen;
+
+    // Create and release the arrays of a forecast for the counts set in begin().  Returns false,
+    // with nothing allocated, when they don't fit in the arena or the heap
+    bool allocateForecast(OWMForecast &wx);
+    void freeForecast(OWMForecast &wx);
+    void freeForecasts();  // Every forecast, including locations kept in the arena
+
+    // Memory set with setArena(), NULL to use the heap.  Forecast arrays are taken from the
+    // start and handed out again by begin(), location records are kept at the end, one place
+    // per slot, and reused by the next addLocation() for the slot
+    uint8_t *_arena;
+    size_t _arenaEnd;       // Usable size, a multiple of 8
+    size_t _arenaUsed;      // Bytes taken by forecast arrays
+    uint8_t _arenaSlots;    // Location records kept at the end
+    uint32_t _arenaRecords; // Bit per slot with a record built in the arena
+    void *arenaTake(size_t size);
+    OWMLocation *arenaRecord(uint8_t slot);
+    OWMLocation *arenaLocation(uint8_t slot);
+    void releaseLocations();
+    template <typename T> T *allocate(size_t count);
+    template <typename T> void release(T *array);
+
+    // Locations for getWeatherAll(), NULL when a slot is free
+    OWMLocation *_locations[OWM_MAX_LOCATIONS];
+
     // Sizing for the JSON file to parse the API response - Sizes from ArduinoJson assistant (https://arduinojson.org/v6/assistant/#/step1)
     // Not needed with Arduino JSON v7 to be depricated
     uint16_t _currentSize;  // min 511, recommended 768
@@ -198,36 +452,335 @@ private:
     uint16_t getJsonSize();  // Total file min size 24614, recommended 32768
 
     // Convert the icon name in the API response to the enumeration
-    Icon convertIcon(String str);
+    Icon convertIcon(const char *str);
+
+    // The http: string for the API call.  begin() writes the part with the units and API key,
+    // getApiCall() writes the location and sections in _sections after it without allocating
+    char _apiCall[OWM_API_CALL_SIZE];
+    uint16_t _apiPrefix;  // Length of the part written by begin(), 0 when it didn't fit
+    const char *getApiCall(float lat, float lon);
+
+    // Sections asked for by the request in progress, the others are left out of the response
+    // and keep their stored values
+    uint8_t _sections;
+    uint8_t requestedSections();  // Sections with a count in begin()
+    void keepSections(OWMForecast &wx);
+    void deriveSections(OWMForecast &wx, uint8_t sections);
+    uint8_t hourCount(const OWMForecast &wx);
+    void hourPoint(const OWMForecast &wx, uint8_t hour, OWMPoint &point);
+    void clearForecasts(uint8_t sections);
+
+    // Call the API for a location and populate wx.  cached requests are for the location set
+    // with setLocation() and use the ETag of the last response
+    bool fetch(float lat, float lon, OWMForecast &wx, bool cached = false);
+    bool sendRequest(float lat, float lon, bool cached = false);
+    const char *startRequest(float lat, float lon, bool cached);
+    bool checkResponse(int httpCode, bool cached);
+    void endRequest(bool parsed);
+
+    // Request driven by poll().  The response is parsed into _staging, which is exchanged with
+    // the forecast of the location once complete so a partly updated forecast is never seen
+    enum PollStep { POLL_REQUEST, POLL_HEADERS, POLL_RECEIVE };
+    bool _polling;
+    PollStep _pollStep;
+    bool _pollAll;       // Refreshing every location
+    int8_t _pollSlot;    // Location being refreshed, -1 for the one set with setLocation()
+    bool _pollOk;
+    uint16_t _pollTime;  // ms poll() may spend reading the response
+    OWMCallback _callback;
+    OWMForecast _staging;
+    bool _stagingReady;
+    OWMForecast *_pollBuffer;  // Forecast the response is parsed into
+    bool prepareStaging();
+    bool startPoll(bool all);
+    int8_t nextLocation(int8_t slot);
+    void finishPoll(bool parsed);
+    void cancelPoll();
+
+    // The transport is kept between calls so the connection to the API server can be reused
+    OWMHttpTransport _httpTransport;
+    OWMTransport *_transport;
+    bool _keepAlive;
+    uint16_t _timeout;  // ms to wait to connect and for more data before giving up
+
+    // Parse the whole API response into a JsonDocument and populate data structures
+    template <typename Input> bool parseDocument(Input &input);
+
+    // Deserialization filter built in begin() so only the keys used by the data structures
+    // and sections requested are stored in the JsonDocument
+    JsonDocument _filter;
+    void buildFilter();
+
+    // Tracks the memory used by the JsonDocument during a call
+    OWMJsonAllocator _jsonAllocator;
+    size_t _jsonMemory;
+    uint32_t _jsonAllocations;
+
+    // Statistics of the request in progress and the ones before it, see getStats()
+    OWMStats _stats;
+    bool _measuring;              // A request was sent and is not recorded yet
+    unsigned long _requestStart;  // millis() when the request was sent
+    unsigned long _bodyStart;     // millis() when the response headers were read
+    uint32_t _parseMicros;        // Spent parsing the body so far
+    uint32_t _heapLowStart;       // ESP.getMinFreeHeap() when the request was sent
+    void sampleHeap();
+
+    // Streaming mode parses the response as it arrives from the network instead of buffering it.
+    // Fields are written straight into the data structures so no copy of the response is kept
+    bool _streaming;
+    bool parseStream(Stream &input, bool chunked = false, int32_t length = -1);
 
-    // Generate the http: string based on location, forecasts requested, units, and API key
-    String getApiCall();
+    // Streamed response state, kept between readStream() calls so a response can be read in
+    // parts.  budget is the most ms to spend, 0 to wait for the whole response
+    enum StreamResult { STREAM_MORE, STREAM_DONE, STREAM_ERROR };
+    OWMStreamParser _json;
+    unsigned long _lastRead;
+    bool _chunked;
+    int32_t _chunkLeft;
+    uint32_t _chunkSize;
+    bool _chunkExtension;
+    bool _lastChunk;
+    int32_t _bodyLeft;  // Bytes of a Content-Length body not read yet, -1 without a length
+    bool _bodyDone;
+    void startStream(bool chunked, int32_t length);
+    StreamResult readStream(Stream &input, uint16_t budget);
+
+    // Forecast being populated by the parsers
+    OWMForecast *_wx;
+
+    // Double buffering: the object itself and _back take turns as the published forecast of the
+    // setLocation() location.  _sequence is incremented when an update starts and when it ends.
+    // Set with setDoubleBuffer() and applied by begin(), which allocates _back
+    bool _doubleBufferSetting;
+    bool _doubleBuffer;
+    OWMForecast _back;
+    std::atomic<OWMForecast *> _front;
+    std::atomic<uint32_t> _sequence;
+    OWMForecast *beginUpdate();
+    void endUpdate(OWMForecast *wx, bool updated);
+
+    // Cache of the setLocation() forecast.  Each section is fresh for its cache time, or the
+    // max-age sent by the server if longer, after the last response that included it
+    uint32_t _cacheTime[OWM_SECTIONS];  // s for current, minutely, hourly, daily and alerts
+    uint8_t _cachedSections;
+    unsigned long _cachedAt[OWM_SECTIONS];
+    uint32_t _maxAge[OWM_SECTIONS];
+    String _etag;
+    uint8_t _etagSections;  // Sections of the request the ETag was sent for
+    bool _notModified;  // Last cached request returned 304 Not Modified
+    uint8_t staleSections();
+    void updateCache();
+
+    // Compact encoding shared by encodeForecast() and the snapshots
+    void encodeTo(OWMEncoder &enc);
+    bool decodeFrom(OWMDecoder &dec);
+    void jsonValue(const OWMStreamParser &json, OWMJsonType type, const char *value);
+
+    // Store one field of a section by its key, and sub key for nested objects, as described by
+    // the section's field table.  Shared by both parsers, the value is either a JsonVariantConst
+    // or the text from the stream parser
+    template <typename T, typename V>
+    void storeRecord(T &wx, const OWMField *fields, size_t count, const char *key, const char *sub, V value);
+    template <typename V> void storeHour(uint8_t i, const char *key, const char *sub, V value);
+    template <typename V> void storeAlert(uint8_t i, const char *key, V value, bool append);
+    template <typename T, typename V> void storeCondition(T &wx, const char *sub, V value);
     
 
 public:
     OWMOneCall();
     ~OWMOneCall();
     /* Begin function to set what forecasts to get, filter to the number of forecasts
-       requested, set the API key and units
+       requested, set the API key and units.  Returns false when the forecasts don't fit in the
+       memory set with setArena(), nothing is then stored until begin() is called again
      */
-    void begin(String apiKey, uint8_t cur, uint8_t min, uint8_t hr, uint8_t dly, OWMUnits units);
+    bool begin(String apiKey, uint8_t cur, uint8_t min, uint8_t hr, uint8_t dly, OWMUnits units);
     
+    // Take the forecasts and locations from buffer instead of the heap, so the memory used is
+    // fixed and begin() can be called any number of times.  Call before begin(), which must be
+    // called again after it.  Size the buffer with OWM_FORECAST_SIZE() and OWM_LOCATION_SIZE,
+    // or use OWMStaticOneCall.  NULL returns to the heap
+    void setArena(void *buffer, size_t size);
+
+    // Bytes of the arena in use, 0 on the heap
+    size_t getArenaUsed();
+
     // Sets the location for the API call
     void setLocation(float latitude, float longitude);
 
+    // Keep the connection to the API server open between getWeather() calls (default true)
+    void setKeepAlive(bool keepAlive);
+
+    // Time in ms to wait to connect and for each part of the response (default 5000)
+    void setTimeout(uint16_t timeout);
+
+    // Close the connection kept open for the next call
+    void disconnect();
+
+    // Send requests through transport instead of the ESP32 HTTPClient, NULL to go back to it.
+    // The transport must exist as long as it is set.  Cancels a request started with
+    // startWeather()
+    void setTransport(OWMTransport *transport);
+
+    // Store the hourly forecast in the hrWx records (default), the hrSeries arrays or both.
+    // Call before begin(), the forecasts keep the storage begin() allocated until it is called
+    // again
+    void setHourlyStorage(OWMStorage storage);
+
+    // Store up to count alerts (default 0, alerts are not requested) with descriptions of up to
+    // textLength characters.  The memory for them is set aside by begin() so the size of the
+    // response does not change the memory used.  Responses with alerts are always streamed, as
+    // a JsonDocument would hold every description in full.  Call before begin()
+    void setAlerts(uint8_t count, uint16_t textLength = 512);
+
+    // Add a location to refresh with getWeatherAll(), each with its own forecast.  Call after
+    // begin().  Returns the slot number, or -1 if the location is out of range, all
+    // OWM_MAX_LOCATIONS slots are used or there is no memory for its forecast
+    int8_t addLocation(float latitude, float longitude);
+
+    // Remove a location and release its forecast
+    void removeLocation(uint8_t slot);
+
+    // Location and forecast in a slot, NULL if the slot is free
+    OWMLocation *getLocation(uint8_t slot);
+
+    // Call the API for every location added, one after the other over the same connection.
+    // Returns the number of locations updated
+    uint8_t getWeatherAll();
+
+    // Parse the API response as it is received instead of loading it into memory first.
+    // Peak memory use is then limited to the data structures.  Off by default, responses
+    // are always streamed when setAlerts() asks for alerts
+    void setStreaming(bool streaming);
+
+    // Peak bytes allocated by the JsonDocument during the last getWeather() call.  Use it
+    // to compare the memory needed by different begin() settings.  0 in streaming mode and
+    // with alerts
+    size_t getJsonMemory();
+
+    // Number of allocations made by the JsonDocument during the last getWeather() call, each
+    // one a heap allocation that can fragment memory.  0 in streaming mode
+    uint32_t getJsonAllocations();
+
+    // Timings, sizes and outcome of the last API call, and totals since resetStats().  Updated
+    // by every request, including each location of getWeatherAll() and poll()
+    const OWMStats &getStats();
+    void resetStats();
+
     // Call the API and populate data structures
     // Returns true if successful, false on error
     bool getWeather();
-    
-    // Variables to store forecast data 
-    // Minute, Hour, and Daily are pointers to dynamically set size based on user quantity filter
-    currentWeather currWx;
-    minuteWeather *minWx;
-    hourlyWeather *hrWx;
-    dailyWeather *dlyWx;
-    String timeZone;
-    int32_t timeZoneOffset;
 
+    // Seconds each section of the forecast stays current.  getWeather() and startWeather() only
+    // request the sections past their time and keep the others, and do not call the API while
+    // every section is within its time.  The ETag of the last response is sent when the same
+    // sections are requested so an unchanged forecast is not sent again.  0 (default) requests
+    // the section every time
+    void setCacheTime(uint32_t current, uint32_t minutely, uint32_t hourly, uint32_t daily, uint32_t alerts = 0);
+
+    // Forget the age and ETag of the stored forecast so the next call gets a new one
+    void clearCache();
+
+    // Write the forecast for the location set with setLocation() to buf in a compact binary
+    // form, for example to relay it to other boards.  Returns the bytes used, or 0 if buf is
+    // too small.  With a NULL buf returns the size needed
+    size_t encodeForecast(uint8_t *buf, size_t size);
+
+    // Replace that forecast with one written by encodeForecast().  The data must use the units
+    // set in begin(), sections and entries not in it are cleared and extra entries ignored.
+    // The data is decoded into the spare forecast also used by startWeather() and only then
+    // shown, so an arena needs room for it.  Returns false, with the forecast unchanged, if the
+    // data is not valid or there is no room
+    bool decodeForecast(const uint8_t *data, size_t len);
+
+    // Save the forecast for the location set with setLocation() in binary form, for example to
+    // a file in flash.  Returns false if it could not all be written
+    bool saveSnapshot(Print &out);
+
+    // Load a forecast saved by saveSnapshot() after begin() and setLocation() have been called
+    // with the same settings, so it can be shown straight away at boot.  The next getWeather()
+    // still calls the API.  Needs the same room as decodeForecast().  Returns false, with the
+    // forecast unchanged, if the snapshot does not match or is incomplete
+    bool loadSnapshot(Stream &in);
+
+    // Fill a second set of data structures for the location set with setLocation() and publish
+    // each complete forecast by switching between the two, so a task on the other core can read
+    // one while the next is received.  Read the forecast through getForecast() as the members
+    // of the object hold only every other update.  Off by default, call before begin() as a
+    // change takes effect when begin() is next called
+    void setDoubleBuffer(bool doubleBuffer);
+
+    // Latest complete forecast for the location set with setLocation().  This is the object
+    // itself unless double buffering is on
+    const OWMForecast *getForecast();
+
+    // Count of updates to that forecast, odd while an update is in progress
+    uint32_t getSequence();
+
+    // Check after reading a forecast from another task: read getSequence(), then getForecast(),
+    // then the fields needed.  Returns true if nothing read can have been overwritten since
+    // getSequence() returned sequence, otherwise read again
+    bool forecastIntact(uint32_t sequence);
+
+    // Entry of the hourly or daily forecast covering time, -1 when it is outside the stored
+    // forecast.  Days run from midnight to midnight local time, using timeZoneOffset.  The
+    // entries are evenly spaced so the position is worked out rather than searched for.  wx is
+    // a location's forecast, NULL for getForecast()
+    int8_t hourAt(uint32_t time, const OWMForecast *wx = NULL);
+    int8_t dayAt(uint32_t time, const OWMForecast *wx = NULL);
+
+    // Forecast values at time, interpolated between the hours around it.  Past the hourly
+    // forecast the daily one is used: temperatures follow the night, morning, day and evening
+    // values at 0, 6, 12 and 18 h local time and rain and snow are spread over the day.
+    // Returns false when time is outside the stored forecast
+    bool forecastAt(uint32_t time, OWMPoint &point, const OWMForecast *wx = NULL);
+
+    // Start calling the API for the location set with setLocation(), or for every location
+    // added with addLocation(), without waiting for the response.  Call poll() until it returns
+    // POLL_DONE or POLL_FAILED.  Returns false if a request is already in progress
+    bool startWeather();
+    bool startWeatherAll();
+
+    // Continue the request started by startWeather() or startWeatherAll().  Each call takes one
+    // step: connecting, sending the request, reading the response headers that have arrived or
+    // reading the response for up to the poll time.  Responses are always parsed as they arrive,
+    // like streaming mode.  Opening a connection waits for the name lookup and connection setup,
+    // and the default HTTPClient transport waits in one call for the response headers, up to
+    // the setTimeout() time; use OWMClientTransport so only a new connection waits
+    OWMPollState poll();
+
+    // Most ms poll() spends reading a response (default 20)
+    void setPollTime(uint16_t pollTime);
+
+    // Function called by poll() as each forecast is finished, NULL for none
+    void setCallback(OWMCallback callback);
+
+    // Populate data structures from an API response read from input, for example a saved
+    // response or one fetched by other means.  Uses streaming mode if enabled
+    // Returns true if successful, false on error
+    bool parseWeather(Stream &input);
+
+};
+
+// OWMOneCall with its forecast memory inside the object, so the size is known when the sketch
+// is linked and nothing for the forecasts comes from the heap.  LOCATIONS is how many locations
+// addLocation() can add and EXTRA the spare forecasts: one for setDoubleBuffer() and one for
+// startWeather(), decodeForecast() or loadSnapshot().  For hourly series or alerts use setArena() with a buffer sized for them
+template <uint8_t MIN, uint8_t HR, uint8_t DLY, uint8_t LOCATIONS = 0, uint8_t EXTRA = 0>
+class OWMStaticOneCall : public OWMOneCall
+{
+private:
+    static const size_t _size = (1 + LOCATIONS + EXTRA) * OWM_FORECAST_SIZE(MIN, HR, DLY) +
+                                LOCATIONS * OWM_LOCATION_SIZE;
+    alignas(8) uint8_t _memory[_size ? _size : 8];
+
+public:
+    OWMStaticOneCall() { setArena(_memory, sizeof(_memory)); }
+    ~OWMStaticOneCall() { setArena(NULL, 0); }  // Release the locations while _memory is valid
+
+    using OWMOneCall::begin;
+    bool begin(String apiKey, uint8_t cur, OWMUnits units) {
+      return OWMOneCall::begin(apiKey, cur, MIN, HR, DLY, units);
+    }
 };
 
 
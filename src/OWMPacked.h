@@ -0,0 +1,111 @@
+/*
+  Compact field types for the packed forecast records of the OWMOneCall library.
+
+  Each type stores a value in fewer bytes and converts to and from the same type and units as
+  the field it replaces, so fields are read and written with the usual syntax.  Values outside
+  the range of a type are clamped to its limits.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWMPACKED_H__
+#define __OWMPACKED_H__
+
+#include <Arduino.h>
+#include <limits>
+#include "OWMConditions.h"
+
+// Fixed point value stored in an integer of type T as value * Scale
+template <typename T, int Scale>
+class OWMFixed
+{
+private:
+    T _raw;
+
+public:
+    OWMFixed &operator=(float value) {
+      float scaled = value * Scale + (value < 0 ? -0.5f : 0.5f);
+      if (scaled <= std::numeric_limits<T>::min()) _raw = std::numeric_limits<T>::min();
+      else if (scaled >= std::numeric_limits<T>::max()) _raw = std::numeric_limits<T>::max();
+      else _raw = (T)scaled;
+      return *this;
+    }
+
+    operator float() const { return (float)_raw / Scale; }
+};
+
+// Hundredths in a signed 16 bit integer: -327.68 to 327.67 (temperature, dew point, speed, UV)
+typedef OWMFixed<int16_t, 100> OWMCenti;
+
+// Hundredths in an unsigned 16 bit integer: 0 to 655.35 (precipitation volume)
+typedef OWMFixed<uint16_t, 100> OWMCentiU;
+
+// Fraction 0 - 1 stored as a percentage in one byte (probability, moon phase)
+typedef OWMFixed<uint8_t, 100> OWMPercent;
+
+// Position + 1 of a condition in the table, 0 when no ID was stored and OWM_CONDITION_UNKNOWN
+// when the ID is not in the table
+inline const OWMCondition *owmPackedCondition(uint8_t index) {
+  return (index && index != OWM_CONDITION_UNKNOWN) ? owmConditionAt(index - 1) : NULL;
+}
+
+// Condition ID stored as its position in the condition table.  IDs that are not in the table
+// read back as OWM_CONDITION_ID_UNKNOWN
+class OWMPackedId
+{
+private:
+    uint8_t _index;
+
+public:
+    OWMPackedId &operator=(uint16_t id) {
+      uint8_t index = owmConditionIndex(id);
+      if (!id) _index = 0;
+      else _index = (index == OWM_CONDITION_UNKNOWN) ? OWM_CONDITION_UNKNOWN : index + 1;
+      return *this;
+    }
+
+    operator uint16_t() const {
+      const OWMCondition *cond = condition();
+      if (cond) return cond->id;
+      return (_index == OWM_CONDITION_UNKNOWN) ? OWM_CONDITION_ID_UNKNOWN : 0;
+    }
+
+    // Table entry for the condition, NULL when unknown
+    const OWMCondition *condition() const { return owmPackedCondition(_index); }
+};
+
+// Main or description text of the condition held in the same byte as an OWMPackedId, "" when
+// the condition is unknown.  Placed in a union with the ID it reads as a const char * field
+template <const char *OWMCondition::*Text>
+class OWMPackedText
+{
+private:
+    uint8_t _index;
+
+public:
+    operator const char *() const {
+      const OWMCondition *cond = owmPackedCondition(_index);
+      return cond ? cond->*Text : "";
+    }
+};
+
+typedef OWMPackedText<&OWMCondition::main> OWMPackedMain;
+typedef OWMPackedText<&OWMCondition::description> OWMPackedDescription;
+
+// Enumeration stored in a single byte
+template <typename E>
+class OWMPackedEnum
+{
+private:
+    uint8_t _value;
+
+public:
+    OWMPackedEnum &operator=(E value) {
+      _value = (uint8_t)value;
+      return *this;
+    }
+
+    operator E() const { return (E)_value; }
+};
+
+#endif
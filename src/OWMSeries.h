@@ -0,0 +1,125 @@
+/*
+  Hourly forecast series for the OWMOneCall library.
+
+  With series storage each hourly value is kept in its own contiguous array (structure of
+  arrays) so statistics over a range of hours and sparklines read consecutive memory.  The
+  helper functions are written with independent accumulators so the compiler can vectorize
+  them on host builds and keep the pipeline busy on the ESP32.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWMSERIES_H__
+#define __OWMSERIES_H__
+
+#include <Arduino.h>
+
+// Where the hourly forecast is stored
+enum OWMStorage {
+  STORE_RECORDS,  // hrWx array of records (default)
+  STORE_SERIES,   // hrSeries arrays only
+  STORE_BOTH
+};
+
+// Number of float series in hourlySeries
+#define OWM_SERIES_FIELDS 12
+
+// Hourly forecast values stored as one array per field, count entries each
+struct hourlySeries {
+  uint8_t count;      // Number of hours in each series, 0 when series storage is off
+  uint32_t *time;     // Unix timestamp
+  float *temp;        // Temperature
+  float *feelsLike;   // Human perception of temperature
+  float *dewPoint;    // Dew Point
+  float *precipProb;  // Probability of precipitation 0 - 1
+  float *windSpeed;   // Wind Speed
+  float *windGust;    // Wind Gust
+  float *uvi;         // UV index
+  float *rain;        // Rain volume for last hour in mm
+  float *snow;        // Snow volume for last hour in mm
+  float *clouds;      // Cloudiness %
+  float *humidity;    // Humidity %
+  float *pressure;    // Pressure hPa
+};
+
+// Statistics over count values of a series starting at first.  With count 0 nothing is read
+// and they return 0, so an empty or unallocated series can be passed
+
+inline float owmSeriesMin(const float *series, uint8_t first, uint8_t count) {
+  if (!count) return 0;
+  const float *v = series + first;
+  float m0 = v[0], m1 = v[0], m2 = v[0], m3 = v[0];
+  uint8_t i = 0;
+
+  for (; i + 4 <= count; i += 4) {
+    m0 = v[i] < m0 ? v[i] : m0;
+    m1 = v[i + 1] < m1 ? v[i + 1] : m1;
+    m2 = v[i + 2] < m2 ? v[i + 2] : m2;
+    m3 = v[i + 3] < m3 ? v[i + 3] : m3;
+  }
+  for (; i < count; i++) m0 = v[i] < m0 ? v[i] : m0;
+
+  m0 = m1 < m0 ? m1 : m0;
+  m2 = m3 < m2 ? m3 : m2;
+  return m2 < m0 ? m2 : m0;
+}
+
+inline float owmSeriesMax(const float *series, uint8_t first, uint8_t count) {
+  if (!count) return 0;
+  const float *v = series + first;
+  float m0 = v[0], m1 = v[0], m2 = v[0], m3 = v[0];
+  uint8_t i = 0;
+
+  for (; i + 4 <= count; i += 4) {
+    m0 = v[i] > m0 ? v[i] : m0;
+    m1 = v[i + 1] > m1 ? v[i + 1] : m1;
+    m2 = v[i + 2] > m2 ? v[i + 2] : m2;
+    m3 = v[i + 3] > m3 ? v[i + 3] : m3;
+  }
+  for (; i < count; i++) m0 = v[i] > m0 ? v[i] : m0;
+
+  m0 = m1 > m0 ? m1 : m0;
+  m2 = m3 > m2 ? m3 : m2;
+  return m2 > m0 ? m2 : m0;
+}
+
+inline float owmSeriesSum(const float *series, uint8_t first, uint8_t count) {
+  if (!count) return 0;
+  const float *v = series + first;
+  float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  uint8_t i = 0;
+
+  for (; i + 4 <= count; i += 4) {
+    s0 += v[i];
+    s1 += v[i + 1];
+    s2 += v[i + 2];
+    s3 += v[i + 3];
+  }
+  for (; i < count; i++) s0 += v[i];
+
+  return (s0 + s1) + (s2 + s3);
+}
+
+inline float owmSeriesMean(const float *series, uint8_t first, uint8_t count) {
+  return count ? owmSeriesSum(series, first, count) / count : 0;
+}
+
+// Position in the series (not relative to first) of the first largest / smallest value, first
+// when count is 0
+inline uint8_t owmSeriesArgMax(const float *series, uint8_t first, uint8_t count) {
+  uint8_t best = first;
+  for (int i = first + 1; i < first + count; i++) {
+    if (series[i] > series[best]) best = i;
+  }
+  return best;
+}
+
+inline uint8_t owmSeriesArgMin(const float *series, uint8_t first, uint8_t count) {
+  uint8_t best = first;
+  for (int i = first + 1; i < first + count; i++) {
+    if (series[i] < series[best]) best = i;
+  }
+  return best;
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+  Request statistics for the OWMOneCall library.
+
+  Every API call records where its time went (connecting, waiting for the response, reading and
+  parsing it), how much was read, the memory used and how it ended.  The totals and a histogram
+  of request times are kept since the last resetStats(), so they can be sent to a telemetry
+  service to compare devices and networks.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWMSTATS_H__
+#define __OWMSTATS_H__
+
+#include <Arduino.h>
+
+// Histogram of request times: the first bucket is under OWM_STATS_FIRST_MS, each following one
+// twice as wide as the one before, and the last is everything longer
+#define OWM_STATS_BUCKETS 8
+#define OWM_STATS_FIRST_MS 125
+
+// How the last request ended
+enum OWMError {
+  OWM_ERROR_NONE,
+  OWM_ERROR_CONNECT,  // No connection to the server
+  OWM_ERROR_SEND,     // The request could not be sent or no response came back
+  OWM_ERROR_HTTP,     // The server answered with a status other than 200 or 304
+  OWM_ERROR_TIMEOUT,  // The response stopped arriving
+  OWM_ERROR_PARSE     // The response is not the JSON expected
+};
+
+struct OWMStats {
+  // Last request
+  int16_t httpCode;       // HTTP status, or the transport error when <= 0
+  OWMError error;
+  uint32_t lookupMs;      // Name lookup, 0 when the connection was reused or the transport includes it in connectMs
+  uint32_t connectMs;     // Connecting, 0 when the connection was reused or the transport can't tell
+  uint32_t firstByteMs;   // Sending the request and reading the response headers
+  uint32_t transferMs;    // Reading the body, without the parsing
+  uint32_t parseMs;       // Parsing the body and storing the values
+  uint32_t totalMs;
+  uint32_t payloadBytes;  // Body bytes read
+  size_t jsonMemory;      // Peak JsonDocument bytes, 0 in streaming mode
+  uint32_t freeHeap;      // Lowest free heap seen during the request, or the heap's low-water mark when the request lowered it
+
+  // Since resetStats()
+  uint32_t requests;
+  uint32_t failures;
+  uint32_t minFreeHeap;   // Lowest freeHeap of any request
+  uint16_t histogram[OWM_STATS_BUCKETS];  // Requests by totalMs.  Halved when a bucket fills, so recent requests count most
+};
+
+// Histogram bucket for a request taking ms
+inline uint8_t owmStatsBucket(uint32_t ms) {
+  uint8_t bucket = 0;
+  for (uint32_t limit = OWM_STATS_FIRST_MS; ms >= limit && bucket < OWM_STATS_BUCKETS - 1; limit *= 2) bucket++;
+  return bucket;
+}
+
+#endif
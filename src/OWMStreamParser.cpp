@@ -0,0 +1,264 @@
+/*
+  Incremental JSON tokenizer for the OWMOneCall library streaming mode.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include "OWMStreamParser.h"
+
+// Containers are tracked in a 32 bit mask, anything nested deeper is rejected
+static const uint8_t _maxNesting = 32;
+
+OWMStreamParser::OWMStreamParser(OWMStreamHandler *handler)
+{
+  _handler = handler;
+  reset();
+}
+
+void OWMStreamParser::reset() {
+  _state = VALUE;
+  _escape = 0;
+  _unicode = 0;
+  _surrogate = 0;
+  _depth = 0;
+  _arrays = 0;
+  _len = 0;
+  _offset = 0;
+  _buf[0] = '\0';
+}
+
+bool OWMStreamParser::feed(char c) {
+  switch (_state) {
+    case IN_KEY:
+    case IN_STRING:
+      if (_escape) return escaped(c);
+      if (c == '"') {
+        if (_state == IN_KEY) {
+          if (_depth <= OWM_JSON_MAX_DEPTH) strlcpy(_key[_depth - 1], _buf, OWM_JSON_KEY_LEN);
+          _state = COLON;
+        } else {
+          report(JSON_STRING);
+        }
+      } else if (c == '\\') {
+        _escape = 1;
+      } else if ((uint8_t)c < 0x20) {
+        _state = FAILED;
+        return false;
+      } else {
+        append(c);
+      }
+      return true;
+
+    case IN_LITERAL:
+      if (isalnum(c) || c == '-' || c == '+' || c == '.') {
+        append(c);
+        return true;
+      }
+      endLiteral();  // The character ending a literal still needs to be processed
+      if (_state == FAILED) return false;
+      break;
+
+    case FAILED:
+      return false;
+
+    default:
+      break;
+  }
+
+  if (c == ' ' || c == '\t' || c == '\n' || c == '\r') return true;
+
+  switch (_state) {
+    case FIRST_VALUE:
+      if (c == ']') return close(true);
+      // fall through
+    case VALUE:
+      if (c == '{') return open(false);
+      if (c == '[') return open(true);
+      _len = 0;
+      _offset = 0;
+      _buf[0] = '\0';
+      if (c == '"') {
+        _state = IN_STRING;
+        return true;
+      }
+      if (c == '-' || isalnum(c)) {
+        append(c);
+        _state = IN_LITERAL;
+        return true;
+      }
+      break;
+
+    case FIRST_KEY:
+      if (c == '}') return close(false);
+      // fall through
+    case KEY:
+      if (c == '"') {
+        _len = 0;
+        _offset = 0;
+        _buf[0] = '\0';
+        _state = IN_KEY;
+        return true;
+      }
+      break;
+
+    case COLON:
+      if (c == ':') {
+        _state = VALUE;
+        return true;
+      }
+      break;
+
+    case AFTER_VALUE:
+      if (c == ',') {
+        if (isArray(_depth - 1)) {
+          if (_depth <= OWM_JSON_MAX_DEPTH) _index[_depth - 1]++;
+          _state = VALUE;
+        } else {
+          _state = KEY;
+        }
+        return true;
+      }
+      if (c == ']') return close(true);
+      if (c == '}') return close(false);
+      break;
+
+    case DONE:
+      return true;  // Ignore anything after the document
+
+    default:
+      break;
+  }
+
+  _state = FAILED;
+  return false;
+}
+
+bool OWMStreamParser::open(bool array) {
+  if (_depth >= _maxNesting) {
+    _state = FAILED;
+    return false;
+  }
+
+  if (array) _arrays |= (1UL << _depth);
+  else _arrays &= ~(1UL << _depth);
+
+  if (_depth < OWM_JSON_MAX_DEPTH) {
+    _key[_depth][0] = '\0';
+    _index[_depth] = 0;
+  }
+  _depth++;
+  _state = array ? FIRST_VALUE : FIRST_KEY;
+  return true;
+}
+
+bool OWMStreamParser::close(bool array) {
+  if (_depth == 0 || isArray(_depth - 1) != array) {
+    _state = FAILED;
+    return false;
+  }
+  _depth--;
+  _state = _depth ? AFTER_VALUE : DONE;
+  return true;
+}
+
+void OWMStreamParser::append(char c) {
+  if (_len >= OWM_JSON_VALUE_LEN - 1 && _state == IN_STRING) flush();
+  if (_len < OWM_JSON_VALUE_LEN - 1) {
+    _buf[_len++] = c;
+    _buf[_len] = '\0';
+  }
+}
+
+void OWMStreamParser::appendCodePoint(uint32_t cp) {
+  // Encode as UTF-8, a character that does not fit in the buffer starts the next piece of a
+  // string or is dropped from a key
+  static const uint8_t lead[] = {0x00, 0x00, 0xC0, 0xE0, 0xF0};
+  uint8_t bytes = cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+  if (_len + bytes > OWM_JSON_VALUE_LEN - 1 && _state == IN_STRING) flush();
+  if (_len + bytes > OWM_JSON_VALUE_LEN - 1) return;
+
+  append(lead[bytes] | (cp >> (6 * (bytes - 1))));
+  for (int8_t shift = 6 * (bytes - 2); shift >= 0; shift -= 6) {
+    append(0x80 | ((cp >> shift) & 0x3F));
+  }
+}
+
+bool OWMStreamParser::escaped(char c) {
+  if (_escape == 1) {
+    _escape = 0;
+    switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        append(c);
+        return true;
+      case 'b':
+        append('\b');
+        return true;
+      case 'f':
+        append('\f');
+        return true;
+      case 'n':
+        append('\n');
+        return true;
+      case 'r':
+        append('\r');
+        return true;
+      case 't':
+        append('\t');
+        return true;
+      case 'u':
+        _escape = 2;
+        _unicode = 0;
+        return true;
+      default:
+        _state = FAILED;
+        return false;
+    }
+  }
+
+  // Reading the four hex digits of \uXXXX
+  if (!isxdigit(c)) {
+    _state = FAILED;
+    return false;
+  }
+  _unicode = (_unicode << 4) | (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+  if (++_escape < 6) return true;
+
+  _escape = 0;
+  if (_unicode >= 0xD800 && _unicode <= 0xDBFF) {
+    _surrogate = _unicode;
+  } else if (_unicode >= 0xDC00 && _unicode <= 0xDFFF && _surrogate) {
+    appendCodePoint(0x10000 + ((uint32_t)(_surrogate - 0xD800) << 10) + (_unicode - 0xDC00));
+    _surrogate = 0;
+  } else {
+    appendCodePoint(_unicode);
+    _surrogate = 0;
+  }
+  return true;
+}
+
+void OWMStreamParser::endLiteral() {
+  if (!strcmp(_buf, "true") || !strcmp(_buf, "false")) {
+    report(JSON_BOOL);
+  } else if (!strcmp(_buf, "null")) {
+    report(JSON_NULL);
+  } else if (_buf[0] == '-' || isdigit(_buf[0])) {
+    report(JSON_NUMBER);
+  } else {
+    _state = FAILED;
+  }
+}
+
+// Report the full buffer as a piece of a long string and start the next piece
+void OWMStreamParser::flush() {
+  if (_depth <= OWM_JSON_MAX_DEPTH) _handler->jsonValue(*this, JSON_STRING_PART, _buf);
+  _offset += _len;
+  _len = 0;
+  _buf[0] = '\0';
+}
+
+void OWMStreamParser::report(OWMJsonType type) {
+  if (_depth <= OWM_JSON_MAX_DEPTH) _handler->jsonValue(*this, type, _buf);
+  _state = _depth ? AFTER_VALUE : DONE;
+}
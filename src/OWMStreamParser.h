@@ -0,0 +1,106 @@
+/*
+  Incremental JSON tokenizer for the OWMOneCall library streaming mode.
+
+  Characters are pushed in one at a time as they arrive from the network and every
+  scalar value is reported to a handler together with the path of keys and array
+  indexes that lead to it.  Only the token currently being read is buffered, so the
+  memory used does not depend on the size of the API response.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWMSTREAMPARSER_H__
+#define __OWMSTREAMPARSER_H__
+
+#include <Arduino.h>
+
+// Deepest nesting reported to the handler, values below this are skipped
+#define OWM_JSON_MAX_DEPTH 8
+// Longest key kept in the path, longer keys are truncated
+#define OWM_JSON_KEY_LEN 16
+// Longest value reported to the handler at once, longer strings are reported in pieces
+#define OWM_JSON_VALUE_LEN 64
+
+// Type of the scalar value passed to the handler
+enum OWMJsonType {
+  JSON_NULL,
+  JSON_BOOL,
+  JSON_NUMBER,
+  JSON_STRING,
+  JSON_STRING_PART  // Piece of a long string, the last piece is reported as JSON_STRING
+};
+
+class OWMStreamParser;
+
+// Receives the values found by the parser
+class OWMStreamHandler
+{
+public:
+    // Called for every scalar value.  The path is read from the parser with depth(), key() and index()
+    virtual void jsonValue(const OWMStreamParser &json, OWMJsonType type, const char *value) = 0;
+};
+
+class OWMStreamParser
+{
+private:
+    enum State {
+      VALUE,        // Expecting a value
+      FIRST_VALUE,  // Expecting a value or ']' right after '['
+      FIRST_KEY,    // Expecting a key or '}' right after '{'
+      KEY,          // Expecting the opening quote of a key
+      IN_KEY,       // Reading a key
+      COLON,        // Expecting ':' after a key
+      IN_STRING,    // Reading a string value
+      IN_LITERAL,   // Reading a number, true, false or null
+      AFTER_VALUE,  // Expecting ',' or the end of the container
+      DONE,
+      FAILED
+    };
+
+    OWMStreamHandler *_handler;
+    State _state;
+    uint8_t _escape;      // 0 none, 1 after '\', 2-5 reading the \u hex digits
+    uint16_t _unicode;    // Code point of the \u escape being read
+    uint16_t _surrogate;  // Pending high surrogate of a \u pair
+
+    uint8_t _depth;    // Number of open containers
+    uint32_t _arrays;  // Bit set for each open container that is an array
+    char _key[OWM_JSON_MAX_DEPTH][OWM_JSON_KEY_LEN];
+    int16_t _index[OWM_JSON_MAX_DEPTH];
+
+    char _buf[OWM_JSON_VALUE_LEN];
+    uint8_t _len;
+    uint16_t _offset;  // Characters of the string reported in earlier pieces
+
+    bool open(bool array);
+    bool close(bool array);
+    void append(char c);
+    void flush();
+    void appendCodePoint(uint32_t cp);
+    bool escaped(char c);
+    void endLiteral();
+    void report(OWMJsonType type);
+
+public:
+    OWMStreamParser(OWMStreamHandler *handler);
+
+    // Prepare to parse a new document
+    void reset();
+
+    // Process the next character.  Returns false once the input is found to be invalid
+    bool feed(char c);
+
+    // True once the top level value is complete
+    bool done() const { return _state == DONE; }
+
+    // Path of the value being reported.  Level 0 is the key in the top level object
+    uint8_t depth() const { return _depth; }
+    bool isArray(uint8_t level) const { return level < _depth && (_arrays & (1UL << level)); }
+    const char *key(uint8_t level) const { return (level < OWM_JSON_MAX_DEPTH && level < _depth && !isArray(level)) ? _key[level] : ""; }
+    int16_t index(uint8_t level) const { return (level < OWM_JSON_MAX_DEPTH && isArray(level)) ? _index[level] : -1; }
+
+    // Position in the string of the piece being reported, 0 for the first piece and other values
+    uint16_t offset() const { return _offset; }
+};
+
+#endif
@@ -0,0 +1,352 @@
+/*
+  Transports used by the OWMOneCall library to send requests and read responses.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include "OWMTransport.h"
+
+// Split http://host[:port]/path.  Sets host to the start of the name in url and hostLen to its
+// length, and port when the URL gives one.  Returns the path, empty when there is none
+static const char *splitUrl(const char *url, const char *&host, size_t &hostLen, uint16_t &port) {
+  const char *scheme = strstr(url, "://");
+  host = scheme ? scheme + 3 : url;
+  const char *path = strchr(host, '/');
+  const char *colon = strchr(host, ':');
+
+  if (!path) path = host + strlen(host);
+  if (colon && colon > path) colon = NULL;
+  if (colon) port = atoi(colon + 1);
+  hostLen = (colon ? colon : path) - host;
+  return path;
+}
+
+void OWMTransport::start(const char *url, const char *etag, bool keepAlive, uint16_t timeout) {
+  _startUrl = url;
+  _startEtag = etag;
+  _startKeepAlive = keepAlive;
+  _startTimeout = timeout;
+}
+
+int OWMTransport::update() {
+  int code = get(_startUrl, _startEtag, _startKeepAlive, _startTimeout);
+  return code == OWM_TRANSPORT_PENDING ? HTTPC_ERROR_READ_TIMEOUT : code;
+}
+
+OWMHttpTransport::OWMHttpTransport() : _lookupTime(0), _connectTime(0) {}
+
+int OWMHttpTransport::get(const char *url, const char *etag, bool keepAlive, uint16_t timeout) {
+  static const char *headers[] = {"Transfer-Encoding", "ETag", "Cache-Control"};
+
+  // GET() uses the connection left open when the previous response allowed it, or the one
+  // opened here
+  _lookupTime = 0;
+  _connectTime = 0;
+  _http.setReuse(keepAlive);
+  _http.setConnectTimeout(timeout);
+  _http.setTimeout(timeout);
+  _http.begin(_client, url);
+  if (!_http.connected() && !connect(url, timeout)) return HTTPC_ERROR_CONNECTION_REFUSED;
+  _http.collectHeaders(headers, 3);
+  if (*etag) _http.addHeader("If-None-Match", etag);
+  return _http.GET();
+}
+
+// Look up the server and connect, timing each
+bool OWMHttpTransport::connect(const char *url, uint16_t timeout) {
+  const char *host;
+  size_t hostLen;
+  uint16_t port = 80;
+  char name[64];
+  IPAddress address;
+
+  splitUrl(url, host, hostLen, port);
+  if (hostLen >= sizeof(name)) return false;
+  memcpy(name, host, hostLen);
+  name[hostLen] = 0;
+
+  unsigned long start = millis();
+  bool found = WiFi.hostByName(name, address);
+  _lookupTime = millis() - start;
+  bool connected = found && _client.connect(address, port, timeout);
+  _connectTime = millis() - start;
+  return connected;
+}
+
+Stream &OWMHttpTransport::stream() {
+  return _http.getStream();
+}
+
+bool OWMHttpTransport::chunked() {
+  return _http.header("Transfer-Encoding").equalsIgnoreCase("chunked");
+}
+
+int32_t OWMHttpTransport::size() {
+  return _http.getSize();
+}
+
+String OWMHttpTransport::getString() {
+  return _http.getString();
+}
+
+String OWMHttpTransport::header(const char *name) {
+  return _http.header(name);
+}
+
+void OWMHttpTransport::end(bool complete) {
+  if (!complete) _http.setReuse(false);
+  _http.end();
+}
+
+void OWMHttpTransport::disconnect() {
+  _http.setReuse(false);
+  _http.end();
+}
+
+uint32_t OWMHttpTransport::connectTime() {
+  return _connectTime;
+}
+
+uint32_t OWMHttpTransport::lookupTime() {
+  return _lookupTime;
+}
+
+OWMClientTransport::OWMClientTransport(Client &client, uint16_t port)
+  : _client(client), _port(port), _hostPort(0), _lineLen(0), _chunked(false), _reuse(false), _length(-1),
+    _timeout(5000), _connectTime(0), _step(STEP_IDLE), _path(""), _requestEtag(""), _keepAlive(false), _status(0),
+    _lastByte(0)
+{
+  _host[0] = 0;
+}
+
+int OWMClientTransport::get(const char *url, const char *etag, bool keepAlive, uint16_t timeout) {
+  int code;
+
+  start(url, etag, keepAlive, timeout);
+  while ((code = update()) == OWM_TRANSPORT_PENDING) {
+    if (_step >= STEP_STATUS && !_client.available()) delay(1);
+  }
+  return code;
+}
+
+void OWMClientTransport::start(const char *url, const char *etag, bool keepAlive, uint16_t timeout) {
+  const char *host;
+  size_t hostLen;
+  uint16_t port = _port;
+  const char *path = splitUrl(url, host, hostLen, port);
+
+  _path = *path ? path : "/";
+  _requestEtag = etag;
+  _keepAlive = keepAlive;
+  _timeout = timeout;
+  _connectTime = 0;
+
+  if (hostLen >= sizeof(_host)) {
+    disconnect();
+    _step = STEP_IDLE;
+    return;
+  }
+
+  // Open a new connection unless the last one to the same server can be used again
+  _step = STEP_SEND;
+  if (!_reuse || !_client.connected() || strncmp(_host, host, hostLen) || _host[hostLen] || _hostPort != port) {
+    _client.stop();
+    memcpy(_host, host, hostLen);
+    _host[hostLen] = 0;
+    _hostPort = port;
+    _step = STEP_CONNECT;
+  }
+}
+
+int OWMClientTransport::update() {
+  switch (_step) {
+    case STEP_CONNECT: {
+      unsigned long start = millis();
+      bool connected = _client.connect(_host, _hostPort);
+      _connectTime = millis() - start;
+      if (!connected) return fail(HTTPC_ERROR_CONNECTION_REFUSED);
+      _step = STEP_SEND;
+      return OWM_TRANSPORT_PENDING;
+    }
+
+    case STEP_SEND: {
+      // Written in one piece so the request goes out in a single packet
+      char request[OWM_REQUEST_SIZE];
+      const char *etag = _requestEtag;
+      int len = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: %s\r\n%s%s%s\r\n",
+                         _path, _host, _keepAlive ? "keep-alive" : "close",
+                         *etag ? "If-None-Match: " : "", etag, *etag ? "\r\n" : "");
+      if (len < 0 || len >= (int)sizeof(request) || _client.write((const uint8_t *)request, len) != (size_t)len) {
+        return fail(HTTPC_ERROR_SEND_HEADER_FAILED);
+      }
+      _lastByte = millis();
+      _lineLen = 0;
+      _step = STEP_STATUS;
+      return OWM_TRANSPORT_PENDING;
+    }
+
+    case STEP_STATUS:
+    case STEP_HEADERS:
+      // Only what has arrived is read, the rest on later calls
+      while (_client.available() > 0) {
+        int c = _client.read();
+        if (c < 0) break;
+        _lastByte = millis();
+        if (!addToLine(c)) continue;
+
+        int code = headerLine();
+        if (code != OWM_TRANSPORT_PENDING) return code;
+      }
+      if (!_client.connected() || millis() - _lastByte > _timeout) return fail(HTTPC_ERROR_READ_TIMEOUT);
+      return OWM_TRANSPORT_PENDING;
+
+    default:
+      return HTTPC_ERROR_CONNECTION_REFUSED;  // start() was given a host name too long to hold
+  }
+}
+
+// Close the connection after a failed request
+int OWMClientTransport::fail(int error) {
+  disconnect();
+  _step = STEP_IDLE;
+  return error;
+}
+
+// Status line, then headers up to the blank line before the body.  Returns the status once
+// the headers are complete
+int OWMClientTransport::headerLine() {
+  if (_step == STEP_STATUS) {
+    if (strncmp(_line, "HTTP/1.", 7)) return fail(HTTPC_ERROR_READ_TIMEOUT);
+    _status = atoi(_line + 9);
+    _reuse = _keepAlive && _line[7] == '1';
+    _chunked = false;
+    _length = -1;
+    _etag = "";
+    _cacheControl = "";
+    _step = STEP_HEADERS;
+    return OWM_TRANSPORT_PENDING;
+  }
+
+  if (_line[0]) {
+    char *value = strchr(_line, ':');
+    if (!value) return OWM_TRANSPORT_PENDING;
+    *value++ = 0;
+    while (*value == ' ') value++;
+
+    if (!strcasecmp(_line, "Transfer-Encoding")) _chunked = !strcasecmp(value, "chunked");
+    else if (!strcasecmp(_line, "Content-Length")) _length = atol(value);
+    else if (!strcasecmp(_line, "Connection")) _reuse = _reuse && strcasecmp(value, "close");
+    else if (!strcasecmp(_line, "ETag")) _etag = value;
+    else if (!strcasecmp(_line, "Cache-Control")) _cacheControl = value;
+    return OWM_TRANSPORT_PENDING;
+  }
+
+  // Responses without a body
+  if (_status == 204 || _status == 304) {
+    _chunked = false;
+    _length = 0;
+  }
+
+  // Without a length the body ends when the server closes the connection
+  if (!_chunked && _length < 0) _reuse = false;
+  _step = STEP_IDLE;
+  return _status;
+}
+
+Stream &OWMClientTransport::stream() {
+  return _client;
+}
+
+bool OWMClientTransport::chunked() {
+  return _chunked;
+}
+
+int32_t OWMClientTransport::size() {
+  return _chunked ? -1 : _length;
+}
+
+String OWMClientTransport::getString() {
+  String body;
+  int c;
+
+  if (!_chunked) {
+    if (_length > 0) body.reserve(_length);
+    for (int32_t i = 0; _length < 0 || i < _length; i++) {
+      if ((c = readByte()) < 0) break;
+      body += (char)c;
+    }
+    return body;
+  }
+
+  // Each chunk is a hex size line, the data and CRLF, ending with a zero size chunk and any
+  // trailer lines
+  while (readLine()) {
+    long size = strtol(_line, NULL, 16);
+    if (size <= 0) {
+      while (readLine() && _line[0]) {}
+      break;
+    }
+    body.reserve(body.length() + size);
+    for (long i = 0; i < size; i++) {
+      if ((c = readByte()) < 0) return body;
+      body += (char)c;
+    }
+    readLine();
+  }
+  return body;
+}
+
+String OWMClientTransport::header(const char *name) {
+  if (!strcasecmp(name, "ETag")) return _etag;
+  if (!strcasecmp(name, "Cache-Control")) return _cacheControl;
+  if (!strcasecmp(name, "Transfer-Encoding")) return _chunked ? "chunked" : "";
+  return "";
+}
+
+void OWMClientTransport::end(bool complete) {
+  if (!complete || !_reuse) disconnect();
+}
+
+void OWMClientTransport::disconnect() {
+  _client.stop();
+  _host[0] = 0;
+  _reuse = false;
+}
+
+uint32_t OWMClientTransport::connectTime() {
+  return _connectTime;
+}
+
+// Next byte of the response, -1 after the timeout or when the connection has closed
+int OWMClientTransport::readByte() {
+  unsigned long start = millis();
+
+  while (!_client.available()) {
+    if (!_client.connected() || millis() - start > _timeout) return -1;
+    delay(1);
+  }
+  return _client.read();
+}
+
+// Add c to the line being read, true once the line is complete in _line without the CRLF
+bool OWMClientTransport::addToLine(int c) {
+  if (c == '\n') {
+    if (_lineLen && _line[_lineLen - 1] == '\r') _lineLen--;
+    _line[_lineLen] = 0;
+    _lineLen = 0;
+    return true;
+  }
+  if (_lineLen < sizeof(_line) - 1) _line[_lineLen++] = c;
+  return false;
+}
+
+// Read a line into _line without the CRLF, false on timeout
+bool OWMClientTransport::readLine() {
+  int c;
+
+  _lineLen = 0;
+  while ((c = readByte()) >= 0) {
+    if (addToLine(c)) return true;
+  }
+  return false;
+}
@@ -0,0 +1,169 @@
+/*
+  Transports used by the OWMOneCall library to send requests and read responses.
+
+  OWMOneCall talks to the server through the OWMTransport interface, so the HTTP stack can be
+  chosen per board.  OWMHttpTransport wraps the ESP32 HTTPClient and is used by default.
+  OWMClientTransport writes the request and reads the headers itself over any Arduino Client
+  (WiFiClient, WiFiClientSecure, EthernetClient) using fixed buffers, so no memory is allocated
+  before the request is sent.  Other transports, or a stand-in serving a saved response,
+  implement the same few functions and are set with OWMOneCall::setTransport().
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWMTRANSPORT_H__
+#define __OWMTRANSPORT_H__
+
+#include <Arduino.h>
+#include <Client.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+
+// Size of the request written by OWMClientTransport, which holds the URL and ETag
+#ifndef OWM_REQUEST_SIZE
+#define OWM_REQUEST_SIZE 384
+#endif
+
+// Returned by OWMTransport::update() while the response headers have not all arrived
+#define OWM_TRANSPORT_PENDING 0
+
+class OWMTransport
+{
+public:
+    OWMTransport() : _startUrl(""), _startEtag(""), _startKeepAlive(false), _startTimeout(0) {}
+    virtual ~OWMTransport() {}
+
+    // Send a GET request for url, adding If-None-Match when etag is not empty.  Returns the HTTP
+    // status code, or a value <= 0 when no response was received.  With keepAlive the
+    // connection is left open for the next request when the server allows it
+    virtual int get(const char *url, const char *etag, bool keepAlive, uint16_t timeout) = 0;
+
+    // The same request in steps, for OWMOneCall::poll().  start() sets it up and each update()
+    // call advances it, returning OWM_TRANSPORT_PENDING until the response headers have been
+    // read and then what get() returns.  url and etag must stay valid until then.  By default
+    // the first update() calls get() and waits for the response, transports that can send the
+    // request and wait for the server without blocking override both
+    virtual void start(const char *url, const char *etag, bool keepAlive, uint16_t timeout);
+    virtual int update();
+
+    // Response body, read as it arrives.  chunked() is true when it uses chunked transfer
+    // encoding and still contains the chunk size lines
+    virtual Stream &stream() = 0;
+    virtual bool chunked() = 0;
+
+    // Body length from the Content-Length header, -1 when it is chunked or not sent.  The
+    // streaming parser reads this many bytes even when the JSON ends sooner, so trailing bytes
+    // aren't left in front of the next response on the same connection
+    virtual int32_t size() { return -1; }
+
+    // Complete response body with any chunk framing removed
+    virtual String getString() = 0;
+
+    // Response header value, empty when not sent.  The ETag and Cache-Control headers are
+    // all that is asked for
+    virtual String header(const char *name) = 0;
+
+    // Finish the response.  complete is false when part of it may be unread, so the connection
+    // can't be used again
+    virtual void end(bool complete) = 0;
+
+    // Close a connection kept open
+    virtual void disconnect() = 0;
+
+    // ms the last get() spent looking up the server and connecting, 0 when it used an open
+    // connection or the transport can't tell.  lookupTime() is the part of it spent on the name
+    // lookup, 0 when it isn't timed apart
+    virtual uint32_t connectTime() { return 0; }
+    virtual uint32_t lookupTime() { return 0; }
+
+private:
+    // Request set up by the default start()
+    const char *_startUrl;
+    const char *_startEtag;
+    bool _startKeepAlive;
+    uint16_t _startTimeout;
+};
+
+// ESP32 HTTPClient.  get() looks up the server and connects before handing the connection to
+// HTTPClient, so both are timed
+class OWMHttpTransport : public OWMTransport
+{
+private:
+    WiFiClient _client;  // Before _http, which still uses it when destroyed
+    HTTPClient _http;
+    uint32_t _lookupTime;
+    uint32_t _connectTime;
+
+    bool connect(const char *url, uint16_t timeout);
+
+public:
+    OWMHttpTransport();
+
+    int get(const char *url, const char *etag, bool keepAlive, uint16_t timeout);
+    Stream &stream();
+    bool chunked();
+    int32_t size();
+    String getString();
+    String header(const char *name);
+    void end(bool complete);
+    void disconnect();
+    uint32_t connectTime();
+    uint32_t lookupTime();
+};
+
+// HTTP/1.1 over an Arduino Client.  port is the server port used whatever the URL scheme, so a
+// WiFiClientSecure with port 443 makes HTTPS requests.  update() connects, sends the request
+// and reads the headers as they arrive in separate steps, only connecting waits for the server
+// since Client::connect() blocks through the name lookup and connection setup.  The lookup is
+// part of connectTime(), as a secure client needs the name rather than an address to check the
+// server certificate
+class OWMClientTransport : public OWMTransport
+{
+private:
+    enum Step { STEP_IDLE, STEP_CONNECT, STEP_SEND, STEP_STATUS, STEP_HEADERS };
+
+    Client &_client;
+    uint16_t _port;
+    char _host[64];      // Server of the open connection
+    uint16_t _hostPort;
+    char _line[128];     // Header line being read, longer lines are truncated
+    uint8_t _lineLen;
+    bool _chunked;
+    bool _reuse;         // The server allows the connection to stay open
+    int32_t _length;     // Content-Length, -1 when not sent
+    uint16_t _timeout;
+    uint32_t _connectTime;
+    String _etag;
+    String _cacheControl;
+
+    // Request in progress
+    Step _step;
+    const char *_path;
+    const char *_requestEtag;
+    bool _keepAlive;
+    int _status;
+    unsigned long _lastByte;  // millis() when the request was sent or the last byte arrived
+
+    int fail(int error);
+    int headerLine();
+    bool addToLine(int c);
+    int readByte();
+    bool readLine();
+
+public:
+    OWMClientTransport(Client &client, uint16_t port = 80);
+
+    int get(const char *url, const char *etag, bool keepAlive, uint16_t timeout);
+    void start(const char *url, const char *etag, bool keepAlive, uint16_t timeout);
+    int update();
+    Stream &stream();
+    bool chunked();
+    int32_t size();
+    String getString();
+    String header(const char *name);
+    void end(bool complete);
+    void disconnect();
+    uint32_t connectTime();
+};
+
+#endif
@@ -0,0 +1,194 @@
+/*
+  Host benchmark of the OWMOneCall library on the checked-in 60/48/8 response.
+
+  For each begin() configuration and parsing mode it reports the median time, the peak heap
+  above what was in use before and the number of allocations of:
+    parse   parseWeather() on the response in memory
+    fetch   getWeather() from the loopback mock server, the response read from the socket
+    client  the same through OWMClientTransport instead of HTTPClient
+  Heap and allocations are counted by wrapping malloc for the main thread, so the mock server's
+  threads are left out.  The packed build (owm_benchmark_packed) gives the packed records.
+
+  Built against a version without the transports (OWM_BASELINE_API, see the README) only the
+  fetch figures in document mode exist.
+
+    owm_benchmark [runs] [connect ms]
+
+  connect ms delays the first response on every new connection, standing in for the TLS
+  handshake of the real server, so the fetch figures show what reusing a connection saves.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <OWMOneCall.h>
+#include <MockServer.h>
+#include <Fixtures.h>
+#include <algorithm>
+#include <malloc.h>
+#include <new>
+#include <vector>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+}
+
+// Allocations by the main thread
+static thread_local bool counted;
+static size_t heapUsed, heapPeak;
+static uint32_t allocations;
+
+static void added(void *ptr) {
+  if (!counted || !ptr) return;
+  allocations++;
+  heapUsed += malloc_usable_size(ptr);
+  if (heapUsed > heapPeak) heapPeak = heapUsed;
+}
+
+static void removed(void *ptr) {
+  if (counted && ptr) heapUsed -= std::min(heapUsed, malloc_usable_size(ptr));
+}
+
+extern "C" {
+void *malloc(size_t size) {
+  void *ptr = __libc_malloc(size);
+  added(ptr);
+  return ptr;
+}
+
+void *calloc(size_t count, size_t size) {
+  void *ptr = __libc_calloc(count, size);
+  added(ptr);
+  return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+  removed(ptr);
+  void *moved = __libc_realloc(ptr, size);
+  added(moved ? moved : (size ? ptr : NULL));
+  return moved;
+}
+
+void free(void *ptr) {
+  removed(ptr);
+  __libc_free(ptr);
+}
+}
+
+// ESP.getFreeHeap() and getMinFreeHeap() report these instead of the process heap
+size_t hostHeapUsed() { return heapUsed; }
+size_t hostHeapPeak() { return heapPeak; }
+
+struct Measure {
+  uint32_t micros;
+  size_t peak;
+  uint32_t allocations;
+};
+
+struct Config {
+  const char *name;
+  uint8_t cur, min, hr, dly;
+};
+
+enum Mode { DOCUMENT, STREAMING, SERIES };
+static const char *const modeNames[] = {"document", "streaming", "series"};
+
+// Runs step once untimed, then runs times, and gives the median time and the figures of the
+// last run
+template <typename Step>
+static Measure measure(int runs, Step step) {
+  std::vector<uint32_t> times;
+  Measure result = {0, 0, 0};
+
+  step();
+  for (int i = 0; i < runs; i++) {
+    size_t start = heapUsed;
+    heapPeak = heapUsed;
+    allocations = 0;
+    unsigned long begin = micros();
+    bool ok = step();
+    times.push_back(micros() - begin);
+    result.peak = heapPeak - start;
+    result.allocations = allocations;
+    if (!ok) {
+      printf("    failed\n");
+      exit(1);
+    }
+  }
+  std::sort(times.begin(), times.end());
+  result.micros = times[times.size() / 2];
+  return result;
+}
+
+static void print(const Config &config, const char *mode, const char *what, const Measure &m) {
+  printf("%-12s %-10s %-6s %9u %10zu %8u\n", config.name, mode, what, m.micros, m.peak, m.allocations);
+}
+
+int main(int argc, char **argv) {
+  int runs = argc > 1 ? atoi(argv[1]) : 25;
+  unsigned connectMs = argc > 2 ? atoi(argv[2]) : 0;
+  std::string response = loadFixture("full.json");
+  const Config configs[] = {
+    {"1/60/48/8", 1, 60, 48, 8},
+    {"1/0/48/8", 1, 0, 48, 8},
+    {"1/0/12/3", 1, 0, 12, 3},
+    {"current", 1, 0, 0, 0},
+  };
+
+  MockServer server;
+  MockResponse ok;
+  ok.body = response;
+  server.respond(ok);
+  server.setConnectDelay(connectMs);
+  WiFiClient::redirect("127.0.0.1", server.port());
+  counted = true;
+
+#ifdef OWM_PACKED_FORECAST
+  const char *build = "packed records";
+#else
+  const char *build = "records";
+#endif
+  printf("Response %zu bytes, %d runs, %u ms to connect, %s\n\n", response.size(), runs, connectMs, build);
+  printf("%-12s %-10s %-6s %9s %10s %8s\n", "begin()", "mode", "", "median us", "peak bytes", "allocs");
+
+  for (const Config &config : configs) {
+#ifdef OWM_BASELINE_API
+    // Older versions leave the arrays of sections not requested uninitialised and delete them
+    // in the destructor, so the object is built in zeroed memory and never destroyed
+    OWMOneCall &owm = *new (calloc(1, sizeof(OWMOneCall))) OWMOneCall;
+    owm.begin("key", config.cur, config.min, config.hr, config.dly, STANDARD);
+    owm.setLocation(33.44, -94.04);
+    print(config, modeNames[DOCUMENT], "fetch", measure(runs, [&] { return owm.getWeather(); }));
+#else
+    for (int mode = DOCUMENT; mode <= SERIES; mode++) {
+      if (mode == SERIES && !config.hr) continue;
+      OWMOneCall owm;
+      owm.setStreaming(mode != DOCUMENT);
+      owm.setHourlyStorage(mode == SERIES ? STORE_SERIES : STORE_RECORDS);
+      owm.begin("key", config.cur, config.min, config.hr, config.dly, STANDARD);
+      owm.setLocation(33.44, -94.04);
+
+      StringStream input(response);
+      print(config, modeNames[mode], "parse", measure(runs, [&] {
+        input.rewind();
+        return owm.parseWeather(input);
+      }));
+      print(config, modeNames[mode], "fetch", measure(runs, [&] { return owm.getWeather(); }));
+      owm.disconnect();
+
+      WiFiClient client;
+      OWMClientTransport transport(client);
+      owm.setTransport(&transport);
+      print(config, modeNames[mode], "client", measure(runs, [&] { return owm.getWeather(); }));
+      owm.disconnect();
+      owm.setTransport(NULL);
+    }
+#endif
+  }
+
+  counted = false;
+  WiFiClient::redirect(NULL, 0);
+  return 0;
+}
@@ -0,0 +1,61 @@
+# Writes the test fixtures: a One Call 3.0 response with every section, made up in the form of
+# the example in the API documentation (https://openweathermap.org/api/one-call-3)
+#   python3 generate.py full > full.json
+#   python3 generate.py compact > compact.json      same response without whitespace
+#   python3 generate.py localized > localized.json  descriptions not in the condition table
+#   python3 generate.py minimal > minimal.json      current weather only
+import json, random, sys
+mode = sys.argv[1] if len(sys.argv) > 1 else "full"
+random.seed(1)
+conds = [(800,"Clear","clear sky","01"),(801,"Clouds","few clouds","02"),(802,"Clouds","scattered clouds","03"),
+         (803,"Clouds","broken clouds","04"),(804,"Clouds","overcast clouds","04"),(500,"Rain","light rain","10"),
+         (501,"Rain","moderate rain","10"),(211,"Thunderstorm","thunderstorm","11"),(600,"Snow","light snow","13"),
+         (701,"Mist","mist","50"),(520,"Rain","light intensity shower rain","09")]
+def w(d=True):
+    c = random.choice(conds)
+    return [{"id":c[0],"main":c[1],"description":c[2],"icon":c[3]+("d" if d else "n")}]
+t0 = 1684929490
+cur = {"dt":t0,"sunrise":1684926645,"sunset":1684977332,"temp":292.55,"feels_like":292.87,"pressure":1014,
+       "humidity":89,"dew_point":290.69,"uvi":0.16,"clouds":53,"visibility":10000,"wind_speed":3.13,
+       "wind_deg":93,"wind_gust":6.71,"weather":w(),"rain":{"1h":2.46}}
+mins = [{"dt":t0-10+60*i,"precipitation":round(random.choice([0,0,0,0.5,1.2,3]),2)} for i in range(61)]
+hrs = []
+for i in range(48):
+    h = {"dt":1684926000+3600*i,"temp":round(280+random.random()*20,2),"feels_like":round(280+random.random()*20,2),
+         "pressure":1000+random.randint(0,30),"humidity":random.randint(20,100),"dew_point":round(275+random.random()*10,2),
+         "uvi":round(random.random()*9,2),"clouds":random.randint(0,100),"visibility":random.choice([10000,8000,500]),
+         "wind_speed":round(random.random()*12,2),"wind_deg":random.randint(0,359),"wind_gust":round(random.random()*20,2),
+         "weather":w(i%24<12),"pop":round(random.random(),2)}
+    if random.random()<0.4: h["rain"]={"1h":round(random.random()*4,2)}
+    if random.random()<0.1: h["snow"]={"1h":round(random.random()*2,2)}
+    hrs.append(h)
+dly = []
+for i in range(8):
+    t = lambda: round(270+random.random()*30,2)
+    d = {"dt":1684951200+86400*i,"sunrise":1684926645+86400*i,"sunset":1684977332+86400*i,"moonrise":1684941060+86400*i,
+         "moonset":1684905480+86400*i,"moon_phase":round(random.random(),2),"summary":"Expect a day of partly cloudy with rain",
+         "temp":{"day":t(),"min":t(),"max":t(),"night":t(),"eve":t(),"morn":t()},
+         "feels_like":{"day":t(),"night":t(),"eve":t(),"morn":t()},"pressure":1016,"humidity":59,"dew_point":290.48,
+         "wind_speed":round(random.random()*10,2),"wind_deg":random.randint(0,359),"wind_gust":round(random.random()*15,2),
+         "weather":w(),"clouds":random.randint(0,100),"pop":round(random.random(),2),"uvi":round(random.random()*9,2)}
+    if random.random()<0.6: d["rain"]=round(random.random()*10,2)
+    if random.random()<0.2: d["snow"]=round(random.random()*5,2)
+    dly.append(d)
+doc = {"lat":33.44,"lon":-94.04,"timezone":"America/Chicago","timezone_offset":-18000,
+       "current":cur,"minutely":mins,"hourly":hrs,"daily":dly,
+       "alerts":[{"sender_name":"NWS Philadelphia - Mount Holly (New Jersey, Delaware, Southeastern Pennsylvania)",
+                  "event":"Small Craft Advisory","start":1684952747,"end":1684988747,
+                  "description":"...SMALL CRAFT ADVISORY REMAINS IN EFFECT FROM 5 PM THIS\nAFTERNOON TO 3 AM EST FRIDAY...\n* WHAT...North winds 15 to 20 kt with gusts up to 25 kt and seas\n3 to 5 ft expected.\n* WHERE...Coastal waters from Little Egg Inlet to Great Egg\nInlet NJ out 20 nm, Coastal waters from Great Egg Inlet to\nCape May NJ out 20 nm and Coastal waters from Manasquan Inlet\nto Little Egg Inlet NJ out 20 nm.\n* WHEN...From 5 PM this afternoon to 3 AM EST Friday.\n* IMPACTS...Conditions will be hazardous to small craft.",
+                  "tags":["Wind"]},
+                 {"sender_name":"NWS","event":"Flood é Watch","start":1684952747,"end":1684988747,"description":"short \"quoted\" \\ text","tags":[]}]}
+if mode == "minimal":
+    doc = {k: doc[k] for k in ("lat", "lon", "timezone", "timezone_offset", "current")}
+elif mode == "localized":
+    german = {"Mist": "Nebel", "light rain": "leichter Regen"}
+    for entry in [cur] + hrs + dly:
+        for key in ("main", "description"):
+            entry["weather"][0][key] = german.get(entry["weather"][0][key], entry["weather"][0][key])
+if mode == "compact":
+    print(json.dumps(doc, separators=(",", ":"), ensure_ascii=True))
+else:
+    print(json.dumps(doc, indent=2, ensure_ascii=True))
@@ -0,0 +1,153 @@
+/*
+  Host stand-in for the Arduino core, see Arduino.h.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include "Arduino.h"
+#include <stdarg.h>
+#include <malloc.h>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static std::chrono::steady_clock::time_point startTime() {
+  static std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return start;
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime()).count();
+}
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime()).count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+#if !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char *dst, const char *src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t copy = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, copy);
+    dst[copy] = 0;
+  }
+  return len;
+}
+
+size_t strlcat(char *dst, const char *src, size_t size) {
+  size_t len = strnlen(dst, size);
+  if (len == size) return size + strlen(src);
+  return len + strlcpy(dst + len, src, size - len);
+}
+#endif
+
+void String::format(double value, unsigned int decimals) {
+  char text[48];
+  snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+  _text = text;
+}
+
+void String::trim() {
+  size_t start = 0;
+  while (start < _text.size() && isspace((unsigned char)_text[start])) start++;
+  size_t end = _text.size();
+  while (end > start && isspace((unsigned char)_text[end - 1])) end--;
+  _text = _text.substr(start, end - start);
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t written = 0;
+  while (size--) {
+    if (!write(*buffer++)) break;
+    written++;
+  }
+  return written;
+}
+
+size_t Print::print(long value, int base) {
+  if (base == 10) return print(String(value));
+  if (value < 0) return print('-') + print((unsigned long)-value, base);
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char text[8 * sizeof(long) + 1];
+  char *p = text + sizeof(text) - 1;
+  if (base < 2) base = 10;
+  *p = 0;
+  do {
+    int digit = value % base;
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while (value);
+  return write(p);
+}
+
+size_t Print::printf(const char *format, ...) {
+  char text[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+  if (len < (int)sizeof(text)) return write((const uint8_t *)text, len);
+
+  std::string longer(len + 1, 0);
+  va_start(args, format);
+  vsnprintf(&longer[0], longer.size(), format, args);
+  va_end(args);
+  return write((const uint8_t *)longer.data(), len);
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    unsigned long start = millis();
+    int c;
+    while ((c = read()) < 0) {
+      if (millis() - start >= _timeout) return count;
+      yield();
+    }
+    buffer[count++] = c;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  String text;
+  char c;
+  while (readBytes(&c, 1) == 1) text += c;
+  return text;
+}
+
+__attribute__((weak)) size_t hostHeapUsed() {
+  return mallinfo2().uordblks;
+}
+
+__attribute__((weak)) size_t hostHeapPeak() {
+  static size_t peak = 0;
+  size_t used = hostHeapUsed();
+  if (used > peak) peak = used;
+  return peak;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  size_t used = hostHeapUsed();
+  return used < OWM_HOST_HEAP_SIZE ? OWM_HOST_HEAP_SIZE - used : 0;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  size_t peak = hostHeapPeak();
+  return peak < OWM_HOST_HEAP_SIZE ? OWM_HOST_HEAP_SIZE - peak : 0;
+}
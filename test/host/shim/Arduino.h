@@ -0,0 +1,187 @@
+/*
+  Host stand-in for the parts of the Arduino core used by the OWMOneCall library, so it can be
+  built and tested on Linux.  String, Print and Stream follow the Arduino API, timing comes from
+  the steady clock and ESP reports the heap of the host process.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWM_HOST_ARDUINO_H__
+#define __OWM_HOST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define F(text) (text)
+#define PROGMEM
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+#ifndef __GLIBC_PREREQ
+#define __GLIBC_PREREQ(major, minor) 0
+#endif
+#if !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char *dst, const char *src, size_t size);
+size_t strlcat(char *dst, const char *src, size_t size);
+#endif
+
+class String
+{
+private:
+    std::string _text;
+
+public:
+    String(const char *text = "") : _text(text ? text : "") {}
+    String(const std::string &text) : _text(text) {}
+    explicit String(char c) : _text(1, c) {}
+    explicit String(int value) : _text(std::to_string(value)) {}
+    explicit String(unsigned int value) : _text(std::to_string(value)) {}
+    explicit String(long value) : _text(std::to_string(value)) {}
+    explicit String(unsigned long value) : _text(std::to_string(value)) {}
+    explicit String(float value, unsigned int decimals = 2) { format(value, decimals); }
+    explicit String(double value, unsigned int decimals = 2) { format(value, decimals); }
+
+    const char *c_str() const { return _text.c_str(); }
+    unsigned int length() const { return _text.size(); }
+    bool isEmpty() const { return _text.empty(); }
+    bool reserve(unsigned int size) { _text.reserve(size); return true; }
+
+    String &operator=(const char *text) { _text = text ? text : ""; return *this; }
+    String &operator+=(const String &other) { _text += other._text; return *this; }
+    String &operator+=(const char *text) { if (text) _text += text; return *this; }
+    String &operator+=(char c) { _text += c; return *this; }
+    String &operator+=(int value) { _text += std::to_string(value); return *this; }
+    String &operator+=(unsigned int value) { _text += std::to_string(value); return *this; }
+    String &operator+=(long value) { _text += std::to_string(value); return *this; }
+    String &operator+=(unsigned long value) { _text += std::to_string(value); return *this; }
+    bool concat(const char *text) { if (text) _text += text; return true; }
+    bool concat(const char *text, unsigned int length) { _text.append(text, length); return true; }
+    bool concat(char c) { _text += c; return true; }
+
+    friend String operator+(const String &a, const String &b) { return String(a._text + b._text); }
+    friend String operator+(const String &a, const char *b) { return String(a._text + b); }
+    friend String operator+(const char *a, const String &b) { return String(a + b._text); }
+
+    bool operator==(const String &other) const { return _text == other._text; }
+    bool operator==(const char *text) const { return _text == (text ? text : ""); }
+    bool operator!=(const String &other) const { return _text != other._text; }
+    bool operator!=(const char *text) const { return !(*this == text); }
+    char operator[](unsigned int index) const { return index < _text.size() ? _text[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    bool equals(const String &other) const { return _text == other._text; }
+    bool equalsIgnoreCase(const String &other) const { return !strcasecmp(c_str(), other.c_str()); }
+    bool startsWith(const String &prefix) const { return _text.compare(0, prefix.length(), prefix._text) == 0; }
+    bool endsWith(const String &suffix) const {
+      return _text.size() >= suffix.length() && _text.compare(_text.size() - suffix.length(), suffix.length(), suffix._text) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const { return position(_text.find(c, from)); }
+    int indexOf(const char *text, unsigned int from = 0) const { return position(_text.find(text, from)); }
+    int indexOf(const String &text, unsigned int from = 0) const { return position(_text.find(text._text, from)); }
+    String substring(unsigned int from) const { return from < _text.size() ? String(_text.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+      if (from > to) std::swap(from, to);
+      return from < _text.size() ? String(_text.substr(from, to - from)) : String();
+    }
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return atof(c_str()); }
+    void toLowerCase() { for (size_t i = 0; i < _text.size(); i++) _text[i] = tolower(_text[i]); }
+    void toUpperCase() { for (size_t i = 0; i < _text.size(); i++) _text[i] = toupper(_text[i]); }
+    void trim();
+
+private:
+    void format(double value, unsigned int decimals);
+    static int position(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *text) { return text ? write((const uint8_t *)text, strlen(text)) : 0; }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+    virtual void flush() {}
+
+    size_t print(const char *text) { return write(text); }
+    size_t print(const String &text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = 10) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = 10) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = 10) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = 10);
+    size_t print(unsigned long value, int base = 10);
+    size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+
+    template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    size_t println(double value, int decimals) { size_t n = print(value, decimals); return n + println(); }
+    size_t println() { return write("\r\n"); }
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+protected:
+    unsigned long _timeout = 1000;  // ms readBytes() waits for each byte
+
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    unsigned long getTimeout() const { return _timeout; }
+    virtual size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    String readString();
+};
+
+// Writes to stdout, reads nothing
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// Heap of the host process, measured against a nominal size so the values behave like the
+// ESP32 ones: free heap falls as memory is allocated
+#define OWM_HOST_HEAP_SIZE 4000000u
+
+class EspClass
+{
+public:
+    uint32_t getHeapSize() { return OWM_HOST_HEAP_SIZE; }
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+};
+
+extern EspClass ESP;
+
+// Bytes allocated by the process now and at most.  The benchmark replaces these with exact
+// counts from its allocator hooks, otherwise they are sampled from mallinfo
+size_t hostHeapUsed();
+size_t hostHeapPeak();
+
+#endif
@@ -0,0 +1,189 @@
+/*
+  Host stand-in for the ESP32 HTTPClient, see HTTPClient.h.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include "HTTPClient.h"
+
+HTTPClient::HTTPClient()
+  : _client(&_ownClient), _port(80), _reuse(true), _canReuse(false), _http10(false), _timeout(5000),
+    _connectTimeout(5000), _size(-1), _chunked(false)
+{
+}
+
+bool HTTPClient::begin(String url) {
+  return begin(_ownClient, url);
+}
+
+bool HTTPClient::begin(WiFiClient &client, String url) {
+  if (_client != &client) {
+    _client->stop();
+    _client = &client;
+  }
+
+  std::string text = url.c_str();
+  size_t scheme = text.find("://");
+
+  if (scheme == std::string::npos || text.compare(0, scheme, "http")) return false;
+  text = text.substr(scheme + 3);
+
+  size_t slash = text.find('/');
+  std::string host = text.substr(0, slash);
+  _path = slash == std::string::npos ? "/" : text.substr(slash);
+
+  size_t colon = host.find(':');
+  _port = colon == std::string::npos ? 80 : atoi(host.c_str() + colon + 1);
+  _host = host.substr(0, colon);
+  return true;
+}
+
+void HTTPClient::end() {
+  // Whatever of the response has arrived is thrown away, as the ESP32 client does
+  if (_client->connected()) {
+    while (_client->available() > 0) _client->read();
+  }
+  if (!_reuse || !_canReuse) _client->stop();
+  _requestHeaders.clear();
+}
+
+void HTTPClient::addHeader(const String &name, const String &value) {
+  _requestHeaders += std::string(name.c_str()) + ": " + value.c_str() + "\r\n";
+}
+
+void HTTPClient::collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {
+  _headers.clear();
+  for (size_t i = 0; i < headerKeysCount; i++) _headers.push_back(std::make_pair(std::string(headerKeys[i]), std::string()));
+}
+
+String HTTPClient::header(const char *name) {
+  for (size_t i = 0; i < _headers.size(); i++) {
+    if (!strcasecmp(_headers[i].first.c_str(), name)) return String(_headers[i].second);
+  }
+  return String();
+}
+
+bool HTTPClient::hasHeader(const char *name) {
+  return header(name).length() > 0;
+}
+
+int HTTPClient::GET() {
+  if (_host.empty()) return HTTPC_ERROR_NOT_CONNECTED;
+
+  // Like the ESP32 client, an open connection is used whoever opened it
+  if (!_client->connected()) {
+    _client->stop();
+    _client->setConnectTimeout(_connectTimeout);
+    if (!_client->connect(_host.c_str(), _port)) return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+
+  std::string request = "GET " + _path + (_http10 ? " HTTP/1.0\r\n" : " HTTP/1.1\r\n");
+  request += "Host: " + _host + "\r\n";
+  request += "User-Agent: ESP32HTTPClient\r\n";
+  request += std::string("Connection: ") + (_reuse ? "keep-alive" : "close") + "\r\n";
+  request += _requestHeaders + "\r\n";
+  if (_client->write((const uint8_t *)request.data(), request.size()) != request.size()) {
+    _client->stop();
+    return HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+
+  std::string line;
+  if (!readLine(line) || line.compare(0, 7, "HTTP/1.")) {
+    _client->stop();
+    return HTTPC_ERROR_READ_TIMEOUT;
+  }
+  int code = atoi(line.c_str() + 9);
+  _canReuse = line[7] == '1' && !_http10;
+  _size = -1;
+  _chunked = false;
+  for (size_t i = 0; i < _headers.size(); i++) _headers[i].second.clear();
+
+  while (true) {
+    if (!readLine(line)) {
+      _client->stop();
+      return HTTPC_ERROR_READ_TIMEOUT;
+    }
+    if (line.empty()) break;
+
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    std::string name = line.substr(0, colon);
+    size_t start = line.find_first_not_of(' ', colon + 1);
+    std::string value = start == std::string::npos ? "" : line.substr(start);
+
+    if (!strcasecmp(name.c_str(), "Content-Length")) _size = atoi(value.c_str());
+    else if (!strcasecmp(name.c_str(), "Transfer-Encoding")) _chunked = !strcasecmp(value.c_str(), "chunked");
+    else if (!strcasecmp(name.c_str(), "Connection")) _canReuse = _canReuse && strcasecmp(value.c_str(), "close");
+    for (size_t i = 0; i < _headers.size(); i++) {
+      if (!strcasecmp(_headers[i].first.c_str(), name.c_str())) _headers[i].second = value;
+    }
+  }
+  if (!_chunked && _size < 0 && code != HTTP_CODE_NO_CONTENT && code != HTTP_CODE_NOT_MODIFIED) _canReuse = false;
+  return code;
+}
+
+String HTTPClient::getString() {
+  std::string body;
+  int c;
+
+  if (!_chunked) {
+    if (_size > 0) body.reserve(_size);
+    for (int i = 0; _size < 0 || i < _size; i++) {
+      if ((c = readByte()) < 0) break;
+      body += (char)c;
+    }
+    return String(body);
+  }
+
+  std::string line;
+  while (readLine(line)) {
+    long size = strtol(line.c_str(), NULL, 16);
+    if (size <= 0) {
+      while (readLine(line) && !line.empty()) {}
+      break;
+    }
+    for (long i = 0; i < size; i++) {
+      if ((c = readByte()) < 0) return String(body);
+      body += (char)c;
+    }
+    readLine(line);
+  }
+  return String(body);
+}
+
+String HTTPClient::errorToString(int error) {
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED: return String("connection refused");
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return String("send header failed");
+    case HTTPC_ERROR_NOT_CONNECTED: return String("not connected");
+    case HTTPC_ERROR_CONNECTION_LOST: return String("connection lost");
+    case HTTPC_ERROR_READ_TIMEOUT: return String("read Timeout");
+    default: return String();
+  }
+}
+
+// Next byte of the response, -1 after the timeout or when the connection has closed
+int HTTPClient::readByte() {
+  unsigned long start = millis();
+  int c;
+
+  while ((c = _client->read()) < 0) {
+    if (!_client->connected() || millis() - start > _timeout) return -1;
+    delay(1);
+  }
+  return c;
+}
+
+bool HTTPClient::readLine(std::string &line) {
+  int c;
+
+  line.clear();
+  while ((c = readByte()) >= 0) {
+    if (c == '\n') {
+      if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+      return true;
+    }
+    line += (char)c;
+  }
+  return false;
+}
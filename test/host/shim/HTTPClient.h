@@ -0,0 +1,90 @@
+/*
+  Host stand-in for the ESP32 HTTPClient, for plain http:// URLs.  It follows the ESP32 client
+  where the library depends on it: the connection is kept for the next GET() to the same server
+  when setReuse(true) and the server allow it, an open connection is used whoever opened it,
+  getStream() returns the raw connection with any
+  chunk framing, and end() throws away whatever of the response is waiting before keeping the
+  connection.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWM_HOST_HTTPCLIENT_H__
+#define __OWM_HOST_HTTPCLIENT_H__
+
+#include "WiFiClient.h"
+#include <utility>
+#include <vector>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+enum t_http_codes {
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_NO_CONTENT = 204,
+  HTTP_CODE_NOT_MODIFIED = 304,
+  HTTP_CODE_BAD_REQUEST = 400,
+  HTTP_CODE_UNAUTHORIZED = 401,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_TOO_MANY_REQUESTS = 429,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500
+};
+
+class HTTPClient
+{
+private:
+    WiFiClient _ownClient;       // Used by begin(url)
+    WiFiClient *_client;
+    std::string _host;
+    uint16_t _port;
+    std::string _path;
+    bool _reuse;
+    bool _canReuse;              // The last response allows the connection to stay open
+    bool _http10;
+    uint16_t _timeout;
+    int32_t _connectTimeout;
+    int _size;                   // Content-Length, -1 when not sent
+    bool _chunked;
+    std::string _requestHeaders;
+    std::vector<std::pair<std::string, std::string>> _headers;  // Collected response headers
+
+    bool readLine(std::string &line);
+    int readByte();
+
+public:
+    HTTPClient();
+    ~HTTPClient() { end(); }
+
+    bool begin(String url);
+    bool begin(WiFiClient &client, String url);
+    void end();
+
+    void setReuse(bool reuse) { _reuse = reuse; }
+    void useHTTP10(bool http10) { _http10 = http10; }
+    void setTimeout(uint16_t timeout) { _timeout = timeout; }
+    void setConnectTimeout(int32_t timeout) { _connectTimeout = timeout; }
+    void addHeader(const String &name, const String &value);
+    void collectHeaders(const char *headerKeys[], const size_t headerKeysCount);
+    String header(const char *name);
+    bool hasHeader(const char *name);
+
+    int GET();
+    int getSize() { return _size; }
+    WiFiClient &getStream() { return *_client; }
+    WiFiClient *getStreamPtr() { return _client; }
+    String getString();
+    bool connected() { return _client->connected(); }
+
+    static String errorToString(int error);
+};
+
+#endif
@@ -0,0 +1,12 @@
+/*
+  Host stand-in for the ESP32 WiFi.h, see WiFiClient.h.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWM_HOST_WIFI_H__
+#define __OWM_HOST_WIFI_H__
+
+#include "WiFiClient.h"
+
+#endif
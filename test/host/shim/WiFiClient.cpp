@@ -0,0 +1,179 @@
+/*
+  Host stand-in for the ESP32 WiFiClient, see WiFiClient.h.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include "WiFiClient.h"
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+static std::string redirectHost;
+static uint16_t redirectPort;
+static unsigned lookupDelay;
+
+WiFiClass WiFi;
+
+void WiFiClient::redirect(const char *host, uint16_t port) {
+  redirectHost = host ? host : "";
+  redirectPort = port;
+}
+
+void WiFiClass::setLookupDelay(unsigned ms) {
+  lookupDelay = ms;
+}
+
+// Redirected names are found without asking the resolver, as tests use names that don't exist
+int WiFiClass::hostByName(const char *host, IPAddress &address) {
+  usleep(lookupDelay * 1000);
+  if (!redirectHost.empty()) {
+    address = IPAddress(127, 0, 0, 1);
+    return 1;
+  }
+
+  struct addrinfo hints = {};
+  struct addrinfo *addresses;
+  hints.ai_family = AF_INET;
+  if (getaddrinfo(host, NULL, &hints, &addresses)) return 0;
+  const uint8_t *bytes = (const uint8_t *)&((struct sockaddr_in *)addresses->ai_addr)->sin_addr;
+  address = IPAddress(bytes[0], bytes[1], bytes[2], bytes[3]);
+  freeaddrinfo(addresses);
+  return 1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  char host[16];
+  snprintf(host, sizeof(host), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  return open(host, port);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeout) {
+  _connectTimeout = timeout;
+  return connect(ip, port);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port) {
+  usleep(lookupDelay * 1000);
+  return open(host, port);
+}
+
+int WiFiClient::open(const char *host, uint16_t port) {
+  stop();
+  if (!redirectHost.empty()) {
+    host = redirectHost.c_str();
+    port = redirectPort;
+  }
+
+  struct addrinfo hints = {};
+  struct addrinfo *addresses;
+  char service[8];
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  snprintf(service, sizeof(service), "%u", port);
+  if (getaddrinfo(host, service, &hints, &addresses)) return 0;
+
+  for (struct addrinfo *address = addresses; address && _fd < 0; address = address->ai_next) {
+    int fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK, address->ai_protocol);
+    if (fd < 0) continue;
+
+    // Non-blocking connect so the timeout applies
+    int result = ::connect(fd, address->ai_addr, address->ai_addrlen);
+    if (result < 0 && errno == EINPROGRESS) {
+      struct pollfd wait = {fd, POLLOUT, 0};
+      int error = 0;
+      socklen_t len = sizeof(error);
+      if (poll(&wait, 1, _connectTimeout) == 1 && !getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) && !error) {
+        result = 0;
+      }
+    }
+    if (result) {
+      close(fd);
+      continue;
+    }
+    _fd = fd;
+  }
+  freeaddrinfo(addresses);
+  return _fd >= 0;
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size) {
+  size_t sent = 0;
+
+  while (_fd >= 0 && sent < size) {
+    ssize_t n = send(_fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+    if (n > 0) {
+      sent += n;
+    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      struct pollfd wait = {_fd, POLLOUT, 0};
+      if (poll(&wait, 1, 5000) != 1) break;
+    } else {
+      break;
+    }
+  }
+  return sent;
+}
+
+// Reads what has arrived into the buffer once it is empty, false when nothing is there
+bool WiFiClient::fill() {
+  if (_pos < _len) return true;
+  _pos = _len = 0;
+  if (_fd < 0) return false;
+  ssize_t n = recv(_fd, _buffer, sizeof(_buffer), MSG_DONTWAIT);
+  if (n <= 0) return false;
+  _len = n;
+  return true;
+}
+
+// What is buffered when there is any, so reading a byte at a time does not ask the socket
+int WiFiClient::available() {
+  if (_pos < _len) return (int)(_len - _pos);
+  int count = 0;
+  if (_fd < 0 || ioctl(_fd, FIONREAD, &count) < 0) return 0;
+  return count;
+}
+
+int WiFiClient::read() {
+  return fill() ? _buffer[_pos++] : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size) {
+  if (!size || !fill()) return -1;
+  size_t n = std::min(size, _len - _pos);
+  memcpy(buffer, _buffer + _pos, n);
+  _pos += n;
+  return (int)n;
+}
+
+int WiFiClient::peek() {
+  return fill() ? _buffer[_pos] : -1;
+}
+
+void WiFiClient::stop() {
+  if (_fd < 0) return;
+  close(_fd);
+  _fd = -1;
+  _pos = _len = 0;
+}
+
+// Connected until the server has closed the connection and everything it sent has been read
+uint8_t WiFiClient::connected() {
+  if (_fd < 0) return 0;
+  if (_pos < _len || available() > 0) return 1;
+
+  uint8_t c;
+  ssize_t n = recv(_fd, &c, 1, MSG_DONTWAIT | MSG_PEEK);
+  return n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
+
+void WiFiClient::setNoDelay(bool noDelay) {
+  int value = noDelay;
+  if (_fd >= 0) setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+}
@@ -0,0 +1,69 @@
+/*
+  Host stand-in for the ESP32 WiFiClient over a POSIX TCP socket.  Reads never block, like the
+  ESP32 client: read() returns -1 until data has arrived.  The socket is read a segment at a time
+  into a buffer, as the ESP32 client reads from lwIP, so reading a byte at a time does not cost a
+  system call per byte and the benchmark times the library rather than the socket.
+
+  redirect() is for the tests only: it sends every connection to another host and port, so
+  requests for api.openweathermap.org reach the mock server on the loopback interface.  WiFi
+  stands in for the ESP32 WiFiClass, for its name lookup.  setLookupDelay() makes every lookup,
+  including the one in connect() by name, take that much longer.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWM_HOST_WIFICLIENT_H__
+#define __OWM_HOST_WIFICLIENT_H__
+
+#include "Client.h"
+
+class WiFiClient : public Client
+{
+private:
+    int _fd;
+    unsigned long _connectTimeout;  // ms
+    uint8_t _buffer[1460];          // Received and not yet read, from _pos to _len
+    size_t _pos, _len;
+
+    bool fill();
+    int open(const char *host, uint16_t port);
+
+public:
+    WiFiClient() : _fd(-1), _connectTimeout(5000), _pos(0), _len(0) {}
+    ~WiFiClient() { stop(); }
+    WiFiClient(const WiFiClient &) = delete;
+    WiFiClient &operator=(const WiFiClient &) = delete;
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(IPAddress ip, uint16_t port, int32_t timeout);
+    int connect(const char *host, uint16_t port) override;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return _fd >= 0; }
+    using Print::write;
+
+    void setConnectTimeout(unsigned long ms) { _connectTimeout = ms; }
+    void setNoDelay(bool noDelay);
+
+    // Connections made after this go to host:port whatever they ask for.  NULL turns it off
+    static void redirect(const char *host, uint16_t port);
+};
+
+class WiFiClass
+{
+public:
+    int hostByName(const char *host, IPAddress &address);
+
+    static void setLookupDelay(unsigned ms);
+};
+
+extern WiFiClass WiFi;
+
+#endif
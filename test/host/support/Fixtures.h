@@ -0,0 +1,58 @@
+/*
+  Helpers shared by the host tests and benchmark: the checked-in API responses and Streams
+  reading from memory.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWM_HOST_FIXTURES_H__
+#define __OWM_HOST_FIXTURES_H__
+
+#include <Arduino.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// Contents of a file in test/host/fixtures
+inline std::string loadFixture(const char *name) {
+  std::string path = std::string(OWM_FIXTURES_DIR) + "/" + name;
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file) throw std::runtime_error("missing fixture " + path);
+  std::stringstream text;
+  text << file.rdbuf();
+  return text.str();
+}
+
+// Stream over text in memory.  With a step, available() reports at most step bytes at a time
+// so the reader sees the response arrive in parts as it would from the network
+class StringStream : public Stream
+{
+private:
+    std::string _text;
+    size_t _pos;
+    size_t _step;
+
+public:
+    explicit StringStream(const std::string &text, size_t step = 0) : _text(text), _pos(0), _step(step) {}
+
+    int available() override {
+      size_t left = _text.size() - _pos;
+      return (int)(_step && _step < left ? _step : left);
+    }
+    int read() override { return _pos < _text.size() ? (unsigned char)_text[_pos++] : -1; }
+    int peek() override { return _pos < _text.size() ? (unsigned char)_text[_pos] : -1; }
+    size_t readBytes(char *buffer, size_t length) override {
+      size_t n = std::min(length, (size_t)available());
+      memcpy(buffer, _text.data() + _pos, n);
+      _pos += n;
+      return n;
+    }
+    size_t write(uint8_t c) override { _text += (char)c; return 1; }
+    using Print::write;
+
+    void rewind() { _pos = 0; }
+    const std::string &text() const { return _text; }
+    size_t position() const { return _pos; }
+};
+
+#endif
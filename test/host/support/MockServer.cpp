@@ -0,0 +1,183 @@
+/*
+  Loopback HTTP server for the host tests, see MockServer.h.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include "MockServer.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+MockServer::MockServer() : _listen(-1), _port(0), _running(false), _connections(0), _connectDelayMs(0) {
+  struct sockaddr_in address = {};
+  socklen_t length = sizeof(address);
+  int on = 1;
+
+  _listen = socket(AF_INET, SOCK_STREAM, 0);
+  setsockopt(_listen, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = 0;  // Any free port
+  if (bind(_listen, (struct sockaddr *)&address, sizeof(address)) || listen(_listen, 8) ||
+      getsockname(_listen, (struct sockaddr *)&address, &length)) {
+    perror("MockServer");
+    return;
+  }
+  _port = ntohs(address.sin_port);
+  _running = true;
+  _acceptThread = std::thread(&MockServer::acceptLoop, this);
+}
+
+MockServer::~MockServer() {
+  stop();
+}
+
+void MockServer::stop() {
+  if (!_running.exchange(false)) return;
+  if (_acceptThread.joinable()) _acceptThread.join();
+  close(_listen);
+  for (size_t i = 0; i < _threads.size(); i++) _threads[i].join();
+  _threads.clear();
+}
+
+void MockServer::respond(const MockResponse &response) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _default = response;
+}
+
+void MockServer::queue(const MockResponse &response) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _queue.push_back(response);
+}
+
+std::vector<std::string> MockServer::requests() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _requests;
+}
+
+int MockServer::connections() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _connections;
+}
+
+void MockServer::clear() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _queue.clear();
+  _requests.clear();
+  _connections = 0;
+}
+
+MockResponse MockServer::next(const std::string &request) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _requests.push_back(request);
+  if (_queue.empty()) return _default;
+  MockResponse response = _queue.front();
+  _queue.pop_front();
+  return response;
+}
+
+void MockServer::acceptLoop() {
+  while (_running) {
+    struct pollfd wait = {_listen, POLLIN, 0};
+    if (poll(&wait, 1, 20) != 1) continue;
+
+    int fd = accept(_listen, NULL, NULL);
+    if (fd < 0) continue;
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    std::lock_guard<std::mutex> lock(_mutex);
+    _connections++;
+    _threads.push_back(std::thread(&MockServer::serve, this, fd));
+  }
+}
+
+static bool sendAll(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    sent += n;
+  }
+  return true;
+}
+
+static const char *reason(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 304: return "Not Modified";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 429: return "Too Many Requests";
+    default: return "Status";
+  }
+}
+
+// Serves requests on one connection until either side closes it or the server stops
+void MockServer::serve(int fd) {
+  std::string received;
+  bool first = true;
+
+  while (_running) {
+    size_t end = received.find("\r\n\r\n");
+    if (end == std::string::npos) {
+      struct pollfd wait = {fd, POLLIN, 0};
+      if (poll(&wait, 1, 20) != 1) continue;
+      char buffer[1024];
+      ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+      if (n <= 0) break;
+      received.append(buffer, n);
+      continue;
+    }
+
+    std::string request = received.substr(0, end);
+    received.erase(0, end + 4);
+    if (first && _connectDelayMs) usleep(_connectDelayMs * 1000);
+    first = false;
+
+    MockResponse response = next(request);
+    if (response.delayMs) usleep(response.delayMs * 1000);
+
+    bool close = response.close || response.omitLength || response.truncate ||
+                 strcasestr(request.c_str(), "Connection: close");
+    char line[96];
+    snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", response.status, reason(response.status));
+    std::string head = line;
+    for (size_t i = 0; i < response.headers.size(); i++) head += response.headers[i] + "\r\n";
+    if (response.chunked) {
+      head += "Transfer-Encoding: chunked\r\n";
+    } else if (!response.omitLength) {
+      head += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+    }
+    head += close ? "Connection: close\r\n\r\n" : "Connection: keep-alive\r\n\r\n";
+
+    std::string body = response.body;
+    if (response.chunked) {
+      std::string framed;
+      for (size_t i = 0; i < body.size(); i += response.chunkSize) {
+        size_t size = std::min(response.chunkSize, body.size() - i);
+        snprintf(line, sizeof(line), "%zx\r\n", size);
+        framed += line + body.substr(i, size) + "\r\n";
+      }
+      body = framed + "0\r\n\r\n";
+    }
+    if (response.truncate && response.truncate < body.size()) body.resize(response.truncate);
+
+    if (response.pauseAt && response.pauseAt < body.size()) {
+      if (!sendAll(fd, head + body.substr(0, response.pauseAt))) break;
+      usleep(response.pauseMs * 1000);
+      head.clear();
+      body.erase(0, response.pauseAt);
+    }
+    if (!sendAll(fd, head + body) || close) break;
+  }
+  shutdown(fd, SHUT_RDWR);
+  ::close(fd);
+}
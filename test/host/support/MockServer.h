@@ -0,0 +1,76 @@
+/*
+  HTTP/1.1 server on the loopback interface standing in for api.openweathermap.org in the host
+  tests.  Each connection is served by its own thread and kept open between requests unless the
+  response or the client closes it.  Responses are taken from a queue in order, then the default
+  one is repeated.  Start it and call WiFiClient::redirect("127.0.0.1", server.port()) so the
+  library's requests reach it.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWM_HOST_MOCKSERVER_H__
+#define __OWM_HOST_MOCKSERVER_H__
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct MockResponse {
+  int status = 200;
+  std::string body;
+  std::vector<std::string> headers;  // Extra "Name: value" lines
+  bool chunked = false;              // Chunked transfer encoding, chunkSize bytes a chunk
+  size_t chunkSize = 1024;
+  bool omitLength = false;           // Neither Content-Length nor chunked, the end is the close
+  bool close = false;                // Close the connection after the response
+  size_t truncate = 0;               // Close after this many body bytes, 0 to send it all
+  unsigned delayMs = 0;              // Wait before answering
+  size_t pauseAt = 0;                // Wait pauseMs after this many body bytes
+  unsigned pauseMs = 0;
+};
+
+class MockServer
+{
+private:
+    int _listen;
+    uint16_t _port;
+    std::atomic<bool> _running;
+    std::thread _acceptThread;
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::deque<MockResponse> _queue;
+    MockResponse _default;
+    std::vector<std::string> _requests;
+    int _connections;
+    unsigned _connectDelayMs;
+
+    void acceptLoop();
+    void serve(int fd);
+    MockResponse next(const std::string &request);
+
+public:
+    MockServer();
+    ~MockServer();
+
+    uint16_t port() const { return _port; }
+
+    // Response to every request once the queue is empty
+    void respond(const MockResponse &response);
+    // Response to the next request
+    void queue(const MockResponse &response);
+
+    // Wait before reading the first request of each new connection, as a TLS handshake would
+    void setConnectDelay(unsigned ms) { _connectDelayMs = ms; }
+
+    // Requests received so far, each the request line and headers
+    std::vector<std::string> requests();
+    int connections();
+    void clear();
+
+    void stop();
+};
+
+#endif
@@ -0,0 +1,232 @@
+/*
+  Checks a stored forecast against the response it came from, read independently of the library
+  with a JsonDocument.  Packed records hold hundredths, so their values are compared to within
+  rounding.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#ifndef __OWM_HOST_ORACLE_H__
+#define __OWM_HOST_ORACLE_H__
+
+#include <OWMOneCall.h>
+#include <gtest/gtest.h>
+#include "Fixtures.h"
+
+#ifdef OWM_PACKED_FORECAST
+#define EXPECT_PACKED_VALUE(actual, expected) EXPECT_NEAR((actual), (expected), 0.0051)
+#else
+#define EXPECT_PACKED_VALUE(actual, expected) EXPECT_FLOAT_EQ((actual), (expected))
+#endif
+
+// Text the library keeps for a condition: packed records only have the table text for the ID
+inline std::string expectedText(JsonVariantConst weather, const char *key) {
+#ifdef OWM_PACKED_FORECAST
+  const OWMCondition *condition = owmCondition(weather["id"].as<uint16_t>());
+  if (condition) return !strcmp(key, "main") ? condition->main : condition->description;
+  return "";
+#else
+  return weather[key].as<const char *>();
+#endif
+}
+
+// Icon for a condition, worked out from its ID by the groups of
+// https://openweathermap.org/weather-conditions and from the day or night letter of the icon
+inline Icon expectedIcon(JsonVariantConst weather) {
+  uint16_t id = weather["id"].as<uint16_t>();
+  std::string icon = weather["icon"].as<const char *>();
+  bool night = !icon.empty() && icon.back() == 'n';
+
+  if (id >= 200 && id < 300) return night ? i11n : i11d;
+  if (id >= 300 && id < 400) return night ? i09n : i09d;
+  if (id == 511) return night ? i13n : i13d;
+  if (id >= 520 && id < 600) return night ? i09n : i09d;
+  if (id >= 500 && id < 600) return night ? i10n : i10d;
+  if (id >= 600 && id < 700) return night ? i13n : i13d;
+  if (id >= 700 && id < 800) return night ? i50n : i50d;
+  if (id == 800) return night ? i01n : i01d;
+  if (id == 801) return night ? i02n : i02d;
+  if (id == 802) return night ? i03n : i03d;
+  if (id == 803 || id == 804) return night ? i04n : i04d;
+  ADD_FAILURE() << "No icon for condition " << id;
+  return ierr;
+}
+
+// Derived values of two forecasts of the same response
+inline void expectSameDerived(const OWMDerived &actual, const OWMDerived &expected) {
+  EXPECT_FLOAT_EQ(actual.heatIndex, expected.heatIndex);
+  EXPECT_FLOAT_EQ(actual.windChill, expected.windChill);
+  EXPECT_EQ(actual.minutesToPrecip, expected.minutesToPrecip);
+  EXPECT_EQ(actual.precipMinutes, expected.precipMinutes);
+  EXPECT_FLOAT_EQ(actual.precip3h, expected.precip3h);
+  EXPECT_FLOAT_EQ(actual.precip24h, expected.precip24h);
+  EXPECT_FLOAT_EQ(actual.high, expected.high);
+  EXPECT_FLOAT_EQ(actual.low, expected.low);
+  EXPECT_EQ(actual.highTime, expected.highTime);
+  EXPECT_EQ(actual.lowTime, expected.lowTime);
+  EXPECT_FLOAT_EQ(actual.maxPrecipProb, expected.maxPrecipProb);
+  EXPECT_FLOAT_EQ(actual.weekHigh, expected.weekHigh);
+  EXPECT_FLOAT_EQ(actual.weekLow, expected.weekLow);
+  EXPECT_EQ(actual.wettestDay, expected.wettestDay);
+}
+
+class ForecastOracle
+{
+private:
+    JsonDocument _doc;
+
+public:
+    explicit ForecastOracle(const std::string &response) {
+      DeserializationError error = deserializeJson(_doc, response.c_str());
+      if (error) throw std::runtime_error(std::string("fixture does not parse: ") + error.c_str());
+    }
+
+    JsonVariantConst operator[](const char *key) const { return _doc[key]; }
+
+    void expectCurrent(const currentWeather &wx) const {
+      JsonVariantConst cur = _doc["current"];
+      EXPECT_EQ(wx.time, cur["dt"].as<uint32_t>());
+      EXPECT_EQ(wx.sunrise, cur["sunrise"].as<uint32_t>());
+      EXPECT_EQ(wx.sunset, cur["sunset"].as<uint32_t>());
+      EXPECT_FLOAT_EQ(wx.temp, cur["temp"].as<float>());
+      EXPECT_FLOAT_EQ(wx.feelsLike, cur["feels_like"].as<float>());
+      EXPECT_EQ(wx.pressure, cur["pressure"].as<uint16_t>());
+      EXPECT_EQ(wx.humidity, cur["humidity"].as<uint8_t>());
+      EXPECT_FLOAT_EQ(wx.dewPoint, cur["dew_point"].as<float>());
+      EXPECT_EQ(wx.clouds, cur["clouds"].as<uint8_t>());
+      EXPECT_FLOAT_EQ(wx.uvi, cur["uvi"].as<float>());
+      EXPECT_EQ(wx.visibility, cur["visibility"].as<uint16_t>());
+      EXPECT_FLOAT_EQ(wx.windSpeed, cur["wind_speed"].as<float>());
+      EXPECT_FLOAT_EQ(wx.windGust, cur["wind_gust"].as<float>());
+      EXPECT_EQ(wx.windDir, cur["wind_deg"].as<uint16_t>());
+      EXPECT_FLOAT_EQ(wx.rain, cur["rain"]["1h"].as<float>());
+      EXPECT_FLOAT_EQ(wx.snow, cur["snow"]["1h"].as<float>());
+      EXPECT_EQ(wx.id, cur["weather"][0]["id"].as<uint16_t>());
+      EXPECT_STREQ(wx.main, cur["weather"][0]["main"].as<const char *>());
+      EXPECT_STREQ(wx.description, cur["weather"][0]["description"].as<const char *>());
+      EXPECT_EQ(wx.ico, expectedIcon(cur["weather"][0]));
+    }
+
+    void expectMinutes(const minuteWeather *wx, uint8_t count) const {
+      for (uint8_t i = 0; i < count; i++) {
+        JsonVariantConst min = _doc["minutely"][i];
+        SCOPED_TRACE(i);
+        EXPECT_EQ(wx[i].time, min["dt"].as<uint32_t>());
+        EXPECT_FLOAT_EQ(wx[i].precip, min["precipitation"].as<float>());
+      }
+    }
+
+    void expectHours(const hourlyRecord *wx, uint8_t count) const {
+      for (uint8_t i = 0; i < count; i++) {
+        JsonVariantConst hr = _doc["hourly"][i];
+        SCOPED_TRACE(i);
+        EXPECT_EQ(wx[i].time, hr["dt"].as<uint32_t>());
+        EXPECT_PACKED_VALUE(wx[i].temp, hr["temp"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].feelsLike, hr["feels_like"].as<float>());
+        EXPECT_EQ(wx[i].pressure, hr["pressure"].as<uint16_t>());
+        EXPECT_EQ(wx[i].humidity, hr["humidity"].as<uint8_t>());
+        EXPECT_PACKED_VALUE(wx[i].dewPoint, hr["dew_point"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].uvi, hr["uvi"].as<float>());
+        EXPECT_EQ(wx[i].clouds, hr["clouds"].as<uint8_t>());
+        EXPECT_EQ(wx[i].visibility, hr["visibility"].as<uint16_t>());
+        EXPECT_PACKED_VALUE(wx[i].windSpeed, hr["wind_speed"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].windGust, hr["wind_gust"].as<float>());
+        EXPECT_EQ(wx[i].windDir, hr["wind_deg"].as<uint16_t>());
+        EXPECT_PACKED_VALUE(wx[i].precipProb, hr["pop"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].rain, hr["rain"]["1h"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].snow, hr["snow"]["1h"].as<float>());
+        EXPECT_EQ(wx[i].id, hr["weather"][0]["id"].as<uint16_t>());
+        EXPECT_STREQ(wx[i].main, expectedText(hr["weather"][0], "main").c_str());
+        EXPECT_STREQ(wx[i].description, expectedText(hr["weather"][0], "description").c_str());
+        EXPECT_EQ(wx[i].ico, expectedIcon(hr["weather"][0]));
+      }
+    }
+
+    void expectSeries(const hourlySeries &series, uint8_t count) const {
+      ASSERT_EQ(series.count, count);
+      for (uint8_t i = 0; i < count; i++) {
+        JsonVariantConst hr = _doc["hourly"][i];
+        SCOPED_TRACE(i);
+        EXPECT_EQ(series.time[i], hr["dt"].as<uint32_t>());
+        EXPECT_FLOAT_EQ(series.temp[i], hr["temp"].as<float>());
+        EXPECT_FLOAT_EQ(series.feelsLike[i], hr["feels_like"].as<float>());
+        EXPECT_FLOAT_EQ(series.dewPoint[i], hr["dew_point"].as<float>());
+        EXPECT_FLOAT_EQ(series.precipProb[i], hr["pop"].as<float>());
+        EXPECT_FLOAT_EQ(series.windSpeed[i], hr["wind_speed"].as<float>());
+        EXPECT_FLOAT_EQ(series.windGust[i], hr["wind_gust"].as<float>());
+        EXPECT_FLOAT_EQ(series.uvi[i], hr["uvi"].as<float>());
+        EXPECT_FLOAT_EQ(series.rain[i], hr["rain"]["1h"].as<float>());
+        EXPECT_FLOAT_EQ(series.snow[i], hr["snow"]["1h"].as<float>());
+        EXPECT_FLOAT_EQ(series.clouds[i], hr["clouds"].as<float>());
+        EXPECT_FLOAT_EQ(series.humidity[i], hr["humidity"].as<float>());
+        EXPECT_FLOAT_EQ(series.pressure[i], hr["pressure"].as<float>());
+      }
+    }
+
+    void expectDays(const dailyRecord *wx, uint8_t count) const {
+      for (uint8_t i = 0; i < count; i++) {
+        JsonVariantConst dly = _doc["daily"][i];
+        SCOPED_TRACE(i);
+        EXPECT_EQ(wx[i].time, dly["dt"].as<uint32_t>());
+        EXPECT_EQ(wx[i].sunrise, dly["sunrise"].as<uint32_t>());
+        EXPECT_EQ(wx[i].sunset, dly["sunset"].as<uint32_t>());
+        EXPECT_EQ(wx[i].moonrise, dly["moonrise"].as<uint32_t>());
+        EXPECT_EQ(wx[i].moonset, dly["moonset"].as<uint32_t>());
+        EXPECT_PACKED_VALUE(wx[i].moonPhase, dly["moon_phase"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].morningTemp, dly["temp"]["morn"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].dayTemp, dly["temp"]["day"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].eveTemp, dly["temp"]["eve"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].nightTemp, dly["temp"]["night"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].maxTemp, dly["temp"]["max"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].minTemp, dly["temp"]["min"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].mornFeels, dly["feels_like"]["morn"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].dayFeels, dly["feels_like"]["day"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].eveFeels, dly["feels_like"]["eve"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].nightFeels, dly["feels_like"]["night"].as<float>());
+        EXPECT_EQ(wx[i].pressure, dly["pressure"].as<uint16_t>());
+        EXPECT_EQ(wx[i].humidity, dly["humidity"].as<uint8_t>());
+        EXPECT_PACKED_VALUE(wx[i].dewPoint, dly["dew_point"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].uvi, dly["uvi"].as<float>());
+        EXPECT_EQ(wx[i].clouds, dly["clouds"].as<uint8_t>());
+        EXPECT_PACKED_VALUE(wx[i].windSpeed, dly["wind_speed"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].windGust, dly["wind_gust"].as<float>());
+        EXPECT_EQ(wx[i].windDir, dly["wind_deg"].as<uint16_t>());
+        EXPECT_PACKED_VALUE(wx[i].precipProb, dly["pop"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].rain, dly["rain"].as<float>());
+        EXPECT_PACKED_VALUE(wx[i].snow, dly["snow"].as<float>());
+        EXPECT_EQ(wx[i].id, dly["weather"][0]["id"].as<uint16_t>());
+        EXPECT_STREQ(wx[i].main, expectedText(dly["weather"][0], "main").c_str());
+        EXPECT_STREQ(wx[i].description, expectedText(dly["weather"][0], "description").c_str());
+        EXPECT_EQ(wx[i].ico, expectedIcon(dly["weather"][0]));
+      }
+    }
+
+    // Alert text is cut to the lengths set aside for it
+    void expectAlerts(const OWMForecast &wx, uint8_t maxAlerts, uint16_t textLength) const {
+      JsonArrayConst alerts = _doc["alerts"];
+      ASSERT_EQ(wx.alertCount, std::min<size_t>(alerts.size(), maxAlerts));
+      for (uint8_t i = 0; i < wx.alertCount; i++) {
+        JsonVariantConst alert = alerts[i];
+        SCOPED_TRACE(i);
+        EXPECT_EQ(wx.alertWx[i].start, alert["start"].as<uint32_t>());
+        EXPECT_EQ(wx.alertWx[i].end, alert["end"].as<uint32_t>());
+        EXPECT_EQ(std::string(wx.alertWx[i].sender),
+                  std::string(alert["sender_name"].as<const char *>()).substr(0, OWM_ALERT_SENDER_LEN - 1));
+        EXPECT_EQ(std::string(wx.alertWx[i].event),
+                  std::string(alert["event"].as<const char *>()).substr(0, OWM_ALERT_EVENT_LEN - 1));
+        EXPECT_EQ(std::string(wx.alertWx[i].description),
+                  std::string(alert["description"].as<const char *>()).substr(0, textLength));
+      }
+    }
+
+    void expectForecast(const OWMForecast &wx, uint8_t min, uint8_t hr, uint8_t dly) const {
+      EXPECT_EQ(wx.timeZone, String(_doc["timezone"].as<const char *>()));
+      EXPECT_EQ(wx.timeZoneOffset, _doc["timezone_offset"].as<int32_t>());
+      expectCurrent(wx.currWx);
+      if (min) expectMinutes(wx.minWx, min);
+      if (hr && wx.hrWx) expectHours(wx.hrWx, hr);
+      if (dly) expectDays(wx.dlyWx, dly);
+    }
+};
+
+#endif
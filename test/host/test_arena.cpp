@@ -0,0 +1,232 @@
+/*
+  Forecast memory from an arena set with setArena() or held by OWMStaticOneCall.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <Oracle.h>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+
+// Heap allocations and frees through operator new and delete on the counting thread.  The
+// forecast arrays and locations come from there when no arena is set.  The operators replace
+// the global ones for the whole test program and pass everything on to malloc and free
+thread_local bool counting = false;
+thread_local size_t news = 0;
+thread_local size_t deletes = 0;
+
+void *countedNew(size_t size) {
+  if (counting) news++;
+  return malloc(size ? size : 1);
+}
+
+void countedDelete(void *ptr) {
+  if (counting && ptr) deletes++;
+  free(ptr);
+}
+
+// Count the allocations and frees of a scope
+class HeapCount
+{
+public:
+    HeapCount() {
+      news = deletes = 0;
+      counting = true;
+    }
+    ~HeapCount() { counting = false; }
+};
+
+}  // namespace
+
+void *operator new(size_t size) {
+  void *ptr = countedNew(size);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return countedNew(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return countedNew(size); }
+void operator delete(void *ptr) noexcept { countedDelete(ptr); }
+void operator delete[](void *ptr) noexcept { countedDelete(ptr); }
+void operator delete(void *ptr, size_t) noexcept { countedDelete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { countedDelete(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { countedDelete(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { countedDelete(ptr); }
+
+namespace {
+
+const size_t FULL = OWM_FORECAST_SIZE(60, 48, 8);
+
+bool parse(OWMOneCall &owm, const std::string &response) {
+  StringStream input(response);
+  return owm.parseWeather(input);
+}
+
+TEST(Arena, SizedForTheCounts) {
+  std::string response = loadFixture("full.json");
+  // Series, alerts and a second forecast for double buffering
+  const size_t size = 2 * (OWM_FORECAST_SIZE(0, 48, 8) + OWM_SERIES_SIZE(48) + OWM_ALERTS_SIZE(2, 120));
+  std::vector<uint64_t> buffer(FULL / 8), larger(size / 8);
+  OWMOneCall owm;
+  owm.setArena(buffer.data(), FULL);
+  EXPECT_EQ(owm.getArenaUsed(), 0u);
+
+  ASSERT_TRUE(owm.begin("key", 1, 60, 48, 8, STANDARD));
+  EXPECT_EQ(owm.getArenaUsed(), FULL);
+  EXPECT_GE((uint8_t *)owm.minWx, (uint8_t *)buffer.data());
+  EXPECT_LT((uint8_t *)owm.dlyWx, (uint8_t *)buffer.data() + FULL);
+  owm.setLocation(33.44, -94.04);
+  ASSERT_TRUE(parse(owm, response));
+  ForecastOracle(response).expectForecast(owm, 60, 48, 8);
+
+  owm.setHourlyStorage(STORE_BOTH);
+  owm.setAlerts(2, 120);
+  owm.setDoubleBuffer(true);
+  owm.setArena(larger.data(), size);
+  ASSERT_TRUE(owm.begin("key", 1, 0, 48, 8, STANDARD));
+  EXPECT_EQ(owm.getArenaUsed(), size);
+  ASSERT_TRUE(parse(owm, response));
+  ForecastOracle(response).expectSeries(owm.getForecast()->hrSeries, 48);
+  ForecastOracle(response).expectAlerts(*owm.getForecast(), 2, 120);
+}
+
+TEST(Arena, TooSmallStoresNothing) {
+  std::vector<uint64_t> buffer(FULL / 8);
+  OWMOneCall owm;
+  owm.setArena(buffer.data(), FULL - 8);
+
+  EXPECT_FALSE(owm.begin("key", 1, 60, 48, 8, STANDARD));
+  EXPECT_EQ(owm.getArenaUsed(), 0u);
+  EXPECT_EQ(owm.minWx, nullptr);
+  EXPECT_EQ(owm.hrWx, nullptr);
+  EXPECT_EQ(owm.dlyWx, nullptr);
+
+  // Nothing was asked for, so nothing is stored
+  owm.setLocation(33.44, -94.04);
+  std::string response = loadFixture("full.json");
+  EXPECT_TRUE(parse(owm, response));
+  EXPECT_EQ(owm.currWx.time, 0u);
+
+  // Fewer entries fit
+  ASSERT_TRUE(owm.begin("key", 1, 0, 48, 8, STANDARD));
+  EXPECT_EQ(owm.getArenaUsed(), OWM_FORECAST_SIZE(0, 48, 8));
+  ASSERT_TRUE(parse(owm, response));
+  ForecastOracle(response).expectForecast(owm, 0, 48, 8);
+}
+
+TEST(Arena, BeginAgainReusesTheMemory) {
+  OWMStaticOneCall<60, 48, 8> owm;
+  ASSERT_TRUE(owm.begin("key", 1, STANDARD));
+  hourlyRecord *hours = owm.hrWx;
+  EXPECT_EQ(owm.getArenaUsed(), FULL);
+
+  // The same counts again, then fewer, then the same again take the same memory
+  ASSERT_TRUE(owm.begin("key", 1, STANDARD));
+  EXPECT_EQ(owm.getArenaUsed(), FULL);
+  EXPECT_EQ(owm.hrWx, hours);
+
+  ASSERT_TRUE(owm.begin("key", 1, 0, 12, 3, STANDARD));
+  EXPECT_EQ(owm.getArenaUsed(), OWM_FORECAST_SIZE(0, 12, 3));
+  EXPECT_EQ((uint8_t *)owm.hrWx, (uint8_t *)hours - OWM_ARENA_ALIGN(60 * sizeof(minuteWeather)));
+
+  ASSERT_TRUE(owm.begin("key", 1, STANDARD));
+  EXPECT_EQ(owm.getArenaUsed(), FULL);
+  EXPECT_EQ(owm.hrWx, hours);
+
+  // More than the arena holds
+  owm.setHourlyStorage(STORE_BOTH);
+  EXPECT_FALSE(owm.begin("key", 1, STANDARD));
+  EXPECT_EQ(owm.getArenaUsed(), 0u);
+  owm.setHourlyStorage(STORE_RECORDS);
+  ASSERT_TRUE(owm.begin("key", 1, STANDARD));
+  EXPECT_EQ(owm.hrWx, hours);
+}
+
+TEST(Arena, LocationsUntilFull) {
+  const size_t forecast = OWM_FORECAST_SIZE(0, 12, 3);
+  OWMStaticOneCall<0, 12, 3, 2> owm;
+  ASSERT_TRUE(owm.begin("key", 1, STANDARD));
+  EXPECT_EQ(owm.getArenaUsed(), forecast);
+
+  EXPECT_EQ(owm.addLocation(51.5, -0.12), 0);
+  EXPECT_EQ(owm.getArenaUsed(), 2 * forecast + OWM_LOCATION_SIZE);
+  EXPECT_EQ(owm.addLocation(-33.9, 151.2), 1);
+  EXPECT_EQ(owm.getArenaUsed(), 3 * forecast + 2 * OWM_LOCATION_SIZE);
+  EXPECT_EQ(owm.addLocation(40.7, -74.0), -1);
+
+  // A removed location's record is used again
+  owm.removeLocation(0);
+  EXPECT_EQ(owm.addLocation(40.7, -74.0), 0);
+  EXPECT_EQ(owm.addLocation(35.7, 139.7), -1);
+  EXPECT_EQ(owm.getArenaUsed(), 3 * forecast + 2 * OWM_LOCATION_SIZE);
+
+  // begin() with larger counts no longer fits the locations
+  EXPECT_FALSE(owm.begin("key", 1, 0, 24, 3, STANDARD));
+  EXPECT_EQ(owm.getLocation(0)->forecast.hrWx, nullptr);
+}
+
+TEST(Arena, SpareForecast) {
+  OWMOneCall source;
+  ASSERT_TRUE(source.begin("key", 1, 0, 48, 8, STANDARD));
+  source.setLocation(33.44, -94.04);
+  ASSERT_TRUE(parse(source, loadFixture("full.json")));
+  std::vector<uint8_t> data(source.encodeForecast(NULL, 0));
+  source.encodeForecast(data.data(), data.size());
+
+  // Decoding needs the spare forecast, EXTRA sets it aside
+  OWMStaticOneCall<0, 48, 8> without;
+  ASSERT_TRUE(without.begin("key", 1, STANDARD));
+  without.setLocation(33.44, -94.04);
+  EXPECT_FALSE(without.decodeForecast(data.data(), data.size()));
+
+  OWMStaticOneCall<0, 48, 8, 0, 1> with;
+  ASSERT_TRUE(with.begin("key", 1, STANDARD));
+  with.setLocation(33.44, -94.04);
+  EXPECT_TRUE(with.decodeForecast(data.data(), data.size()));
+  EXPECT_EQ(with.getArenaUsed(), 2 * OWM_FORECAST_SIZE(0, 48, 8));
+}
+
+TEST(Arena, NoHeapForForecasts) {
+  std::string response = loadFixture("full.json");
+
+  // On the heap each forecast array and location is allocated and freed
+  {
+    OWMOneCall *heap = new OWMOneCall();
+    HeapCount count;
+    ASSERT_TRUE(heap->begin("key", 1, 60, 48, 8, STANDARD));
+    ASSERT_GE(heap->addLocation(51.5, -0.12), 0);
+    EXPECT_GT(news, 0u);
+    size_t freed = deletes;
+    delete heap;
+    EXPECT_GT(deletes, freed);
+  }
+
+  typedef OWMStaticOneCall<60, 48, 8, 2, 1> Static;
+  Static *owm = new Static();
+  {
+    HeapCount count;
+    ASSERT_TRUE(owm->begin("key", 1, STANDARD));
+    ASSERT_GE(owm->addLocation(51.5, -0.12), 0);
+    ASSERT_GE(owm->addLocation(-33.9, 151.2), 0);
+    EXPECT_EQ(news, 0u);
+  }
+  owm->setLocation(33.44, -94.04);
+  ASSERT_TRUE(parse(*owm, response));
+  {
+    HeapCount count;
+    ASSERT_TRUE(owm->begin("key", 1, STANDARD));
+    owm->removeLocation(0);
+    EXPECT_EQ(news, 0u);
+    EXPECT_EQ(deletes, 0u);
+  }
+
+  // Only the object itself goes back to the heap
+  HeapCount count;
+  delete owm;
+  EXPECT_EQ(deletes, 1u);
+}
+
+}  // namespace
@@ -0,0 +1,64 @@
+/*
+  Forecast cache: per-section cache times and the sections left out of the request.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <MockServer.h>
+#include <Oracle.h>
+
+namespace {
+
+class Cache : public ::testing::Test
+{
+protected:
+    MockServer server;
+    OWMOneCall owm;
+    std::string response;
+
+    void SetUp() override {
+      response = loadFixture("full.json");
+      WiFiClient::redirect("127.0.0.1", server.port());
+      MockResponse ok;
+      ok.body = response;
+      server.respond(ok);
+      owm.setTimeout(1000);
+      ASSERT_TRUE(owm.begin("key", 1, 60, 48, 8, STANDARD));
+      owm.setLocation(33.44, -94.04);
+    }
+
+    void TearDown() override {
+      owm.disconnect();
+      WiFiClient::redirect(NULL, 0);
+    }
+};
+
+TEST_F(Cache, EveryCallRequestsByDefault) {
+  for (int i = 0; i < 3; i++) ASSERT_TRUE(owm.getWeather());
+  EXPECT_EQ(server.requests().size(), 3u);
+}
+
+TEST_F(Cache, FreshForecastIsNotRequested) {
+  owm.setCacheTime(600, 600, 600, 600);
+  for (int i = 0; i < 3; i++) ASSERT_TRUE(owm.getWeather());
+  EXPECT_EQ(server.requests().size(), 1u);
+  ForecastOracle(response).expectForecast(owm, 60, 48, 8);
+
+  owm.clearCache();
+  ASSERT_TRUE(owm.getWeather());
+  EXPECT_EQ(server.requests().size(), 2u);
+}
+
+TEST_F(Cache, OnlyStaleSectionsAreRequested) {
+  owm.setCacheTime(0, 0, 600, 600);
+  ASSERT_TRUE(owm.getWeather());
+  ASSERT_TRUE(owm.getWeather());
+
+  std::vector<std::string> requests = server.requests();
+  ASSERT_EQ(requests.size(), 2u);
+  EXPECT_NE(requests[0].find("&exclude=alerts "), std::string::npos) << requests[0];
+  EXPECT_NE(requests[1].find("&exclude=alerts,daily,hourly "), std::string::npos) << requests[1];
+  ForecastOracle(response).expectForecast(owm, 60, 48, 8);  // The kept sections are unchanged
+}
+
+}  // namespace
@@ -0,0 +1,100 @@
+/*
+  Compact encoding and snapshots of a forecast.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <Oracle.h>
+#include <vector>
+
+namespace {
+
+class Codec : public ::testing::Test
+{
+protected:
+    OWMOneCall owm;
+    std::string response;
+
+    void SetUp() override {
+      response = loadFixture("full.json");
+      ASSERT_TRUE(begin(owm));
+      StringStream input(response);
+      ASSERT_TRUE(owm.parseWeather(input));
+    }
+
+    static bool begin(OWMOneCall &target, OWMUnits units = STANDARD) {
+      if (!target.begin("key", 1, 60, 48, 8, units)) return false;
+      target.setLocation(33.44, -94.04);
+      return true;
+    }
+
+    static std::vector<uint8_t> encoded(OWMOneCall &source) {
+      std::vector<uint8_t> data(source.encodeForecast(NULL, 0));
+      EXPECT_EQ(source.encodeForecast(data.data(), data.size()), data.size());
+      return data;
+    }
+};
+
+TEST_F(Codec, RoundTrip) {
+  std::vector<uint8_t> data = encoded(owm);
+  EXPECT_LT(data.size(), response.size() / 8);
+  EXPECT_EQ(owm.encodeForecast(data.data(), data.size() - 1), 0u);
+
+  OWMOneCall copy;
+  ASSERT_TRUE(begin(copy));
+  ASSERT_TRUE(copy.decodeForecast(data.data(), data.size()));
+  EXPECT_EQ(encoded(copy), data);
+  EXPECT_EQ(copy.hrWx[5].time, owm.hrWx[5].time);
+  EXPECT_NEAR(copy.hrWx[5].temp, owm.hrWx[5].temp, 0.0051);
+  EXPECT_EQ(copy.dlyWx[7].id, owm.dlyWx[7].id);
+  EXPECT_STREQ(copy.currWx.description, owm.currWx.description);
+}
+
+TEST_F(Codec, OtherUnitsAreRejected) {
+  std::vector<uint8_t> data = encoded(owm);
+  OWMOneCall copy;
+  ASSERT_TRUE(begin(copy, IMPERIAL));
+  EXPECT_FALSE(copy.decodeForecast(data.data(), data.size()));
+}
+
+TEST_F(Codec, BadDataKeepsTheForecast) {
+  std::vector<uint8_t> data = encoded(owm);
+
+  for (bool doubleBuffer : {false, true}) {
+    SCOPED_TRACE(doubleBuffer ? "double buffered" : "single");
+    OWMOneCall copy;
+    copy.setDoubleBuffer(doubleBuffer);
+    ASSERT_TRUE(begin(copy));
+    ASSERT_TRUE(copy.decodeForecast(data.data(), data.size()));
+    std::vector<uint8_t> before = encoded(copy);
+
+    EXPECT_FALSE(copy.decodeForecast(data.data(), data.size() / 2));
+    EXPECT_EQ(encoded(copy), before);
+    EXPECT_FLOAT_EQ(copy.getForecast()->currWx.temp, owm.currWx.temp);
+
+    StringStream file("");
+    ASSERT_TRUE(owm.saveSnapshot(file));
+    StringStream truncated(file.text().substr(0, file.text().size() - 10));
+    EXPECT_FALSE(copy.loadSnapshot(truncated));
+    EXPECT_EQ(encoded(copy), before);
+  }
+}
+
+TEST_F(Codec, Snapshot) {
+  StringStream file("");
+  ASSERT_TRUE(owm.saveSnapshot(file));
+
+  OWMOneCall copy;
+  ASSERT_TRUE(begin(copy));
+  StringStream saved(file.text());
+  ASSERT_TRUE(copy.loadSnapshot(saved));
+  EXPECT_EQ(encoded(copy), encoded(owm));
+
+  OWMOneCall elsewhere;
+  ASSERT_TRUE(elsewhere.begin("key", 1, 60, 48, 8, STANDARD));
+  elsewhere.setLocation(51.5, -0.12);
+  StringStream again(file.text());
+  EXPECT_FALSE(elsewhere.loadSnapshot(again));
+}
+
+}  // namespace
@@ -0,0 +1,124 @@
+/*
+  Derived values against National Weather Service reference points.  The heat index and wind
+  chill charts (https://www.weather.gov/safety/heat-index, https://www.weather.gov/safety/cold-wind-chill-chart)
+  are rounded to whole degrees Fahrenheit.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <Oracle.h>
+#include <cstdio>
+
+namespace {
+
+// Chart rounding, in Fahrenheit
+const float CHART = 0.5f;
+
+float fromF(float tempF, OWMUnits units) {
+  if (units == IMPERIAL) return tempF;
+  float celsius = (tempF - 32) * 5 / 9;
+  return units == METRIC ? celsius : celsius + 273.15f;
+}
+
+float speedFromMph(float mph, OWMUnits units) {
+  return units == IMPERIAL ? mph : mph / 2.23694f;
+}
+
+// Current conditions given in Fahrenheit and mph, written in the units of the request
+struct Conditions {
+  float tempF;
+  uint8_t humidity;
+  float dewPointF;
+  float feelsLikeF;  // Chart value
+  float windMph;
+};
+
+void replaceValue(std::string &response, const char *key, float value, int decimals = 2) {
+  std::string name = std::string("\"") + key + "\": ";
+  size_t start = response.find(name) + name.size();
+  size_t end = response.find(',', start);
+  char text[16];
+  snprintf(text, sizeof(text), "%.*f", decimals, value);
+  response.replace(start, end - start, text);
+}
+
+std::string response(const Conditions &conditions, OWMUnits units) {
+  std::string text = loadFixture("minimal.json");
+  replaceValue(text, "temp", fromF(conditions.tempF, units));
+  replaceValue(text, "feels_like", fromF(conditions.feelsLikeF, units));
+  replaceValue(text, "humidity", conditions.humidity, 0);
+  replaceValue(text, "dew_point", fromF(conditions.dewPointF, units));
+  replaceValue(text, "wind_speed", speedFromMph(conditions.windMph, units));
+  return text;
+}
+
+bool parse(OWMOneCall &owm, const std::string &text, OWMUnits units) {
+  if (!owm.begin("key", 1, 0, 0, 0, units)) return false;
+  owm.setLocation(33.44, -94.04);
+  StringStream input(text);
+  return owm.parseWeather(input);
+}
+
+const char *unitName(OWMUnits units) {
+  return units == IMPERIAL ? "imperial" : (units == METRIC ? "metric" : "standard");
+}
+
+TEST(Derived, HeatIndexChart) {
+  const struct {
+    float tempF, humidity, chart;
+  } points[] = {{80, 40, 80}, {86, 90, 105}, {90, 70, 106}, {96, 40, 101}, {100, 50, 118}};
+
+  for (const auto &point : points) {
+    SCOPED_TRACE(testing::Message() << point.tempF << "F " << point.humidity << "%");
+    EXPECT_NEAR(owmHeatIndex(point.tempF, point.humidity), point.chart, CHART);
+  }
+}
+
+TEST(Derived, WindChillChart) {
+  const struct {
+    float tempF, windMph, chart;
+  } points[] = {{40, 5, 36}, {30, 10, 21}, {20, 15, 6}, {0, 15, -19}, {-10, 20, -35}, {5, 30, -19}};
+
+  for (const auto &point : points) {
+    SCOPED_TRACE(testing::Message() << point.tempF << "F " << point.windMph << " mph");
+    EXPECT_NEAR(owmWindChill(point.tempF, point.windMph), point.chart, CHART);
+  }
+
+  // Outside the chart the temperature is returned
+  EXPECT_FLOAT_EQ(owmWindChill(60, 20), 60);
+  EXPECT_FLOAT_EQ(owmWindChill(20, 2), 20);
+}
+
+// A hot humid afternoon: 90F at 70% has a dew point of 79F and feels like 106F
+TEST(Derived, HotInEveryUnit) {
+  const Conditions hot = {90, 70, 78.9f, 106, 5};
+
+  for (OWMUnits units : {IMPERIAL, METRIC, STANDARD}) {
+    SCOPED_TRACE(unitName(units));
+    OWMOneCall owm;
+    ASSERT_TRUE(parse(owm, response(hot, units), units));
+    float tolerance = CHART * (units == IMPERIAL ? 1 : 5.0f / 9);
+    EXPECT_NEAR(owm.currWx.temp, fromF(hot.tempF, units), 0.01);
+    EXPECT_NEAR(owm.currWx.dewPoint, fromF(hot.dewPointF, units), 0.01);
+    EXPECT_NEAR(owm.derived.heatIndex, fromF(hot.feelsLikeF, units), tolerance);
+    EXPECT_NEAR(owm.derived.heatIndex, owm.currWx.feelsLike, tolerance);
+    EXPECT_NEAR(owm.derived.windChill, owm.currWx.temp, 0.01);
+  }
+}
+
+// A cold windy morning: 20F at 60% has a dew point of 8F and with 15 mph of wind feels like 6F
+TEST(Derived, ColdInEveryUnit) {
+  const Conditions cold = {20, 60, 8.3f, 6, 15};
+
+  for (OWMUnits units : {IMPERIAL, METRIC, STANDARD}) {
+    SCOPED_TRACE(unitName(units));
+    OWMOneCall owm;
+    ASSERT_TRUE(parse(owm, response(cold, units), units));
+    float tolerance = CHART * (units == IMPERIAL ? 1 : 5.0f / 9);
+    EXPECT_NEAR(owm.currWx.dewPoint, fromF(cold.dewPointF, units), 0.01);
+    EXPECT_NEAR(owm.derived.windChill, fromF(cold.feelsLikeF, units), tolerance);
+    EXPECT_NEAR(owm.derived.windChill, owm.currWx.feelsLike, tolerance);
+  }
+}
+
+}  // namespace
@@ -0,0 +1,180 @@
+/*
+  Time-indexed lookup and interpolation of a parsed forecast.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <Oracle.h>
+
+namespace {
+
+class Lookup : public ::testing::TestWithParam<OWMStorage>
+{
+protected:
+    std::string response;
+    OWMOneCall owm;
+
+    void SetUp() override {
+      response = loadFixture("full.json");
+      ASSERT_TRUE(parse(owm, response));
+    }
+
+    bool parse(OWMOneCall &target, const std::string &text) {
+      target.setHourlyStorage(GetParam());
+      if (!target.begin("key", 1, 0, 48, 8, STANDARD)) return false;
+      target.setLocation(33.44, -94.04);
+      StringStream input(text);
+      return target.parseWeather(input);
+    }
+
+    JsonVariantConst hour(uint8_t i) const { return oracle()["hourly"][i]; }
+    JsonVariantConst day(uint8_t i) const { return oracle()["daily"][i]; }
+    uint32_t hourTime(uint8_t i) const { return hour(i)["dt"].as<uint32_t>(); }
+
+    // Start of the local day of daily entry i as a Unix timestamp
+    uint32_t midnight(uint8_t i) const {
+      int32_t offset = oracle()["timezone_offset"].as<int32_t>();
+      uint32_t time = day(i)["dt"].as<uint32_t>();
+      return (time + offset) / 86400 * 86400 - offset;
+    }
+
+    const ForecastOracle &oracle() const {
+      static ForecastOracle parsed(loadFixture("full.json"));
+      return parsed;
+    }
+};
+
+TEST_P(Lookup, ExactHour) {
+  EXPECT_EQ(owm.hourAt(hourTime(0)), 0);
+  EXPECT_EQ(owm.hourAt(hourTime(5)), 5);
+  EXPECT_EQ(owm.hourAt(hourTime(5) + 3599), 5);
+  EXPECT_EQ(owm.hourAt(hourTime(47)), 47);
+
+  OWMPoint point;
+  ASSERT_TRUE(owm.forecastAt(hourTime(5), point));
+  EXPECT_TRUE(point.hourly);
+  EXPECT_EQ(point.time, hourTime(5));
+  EXPECT_PACKED_VALUE(point.temp, hour(5)["temp"].as<float>());
+  EXPECT_PACKED_VALUE(point.feelsLike, hour(5)["feels_like"].as<float>());
+  EXPECT_FLOAT_EQ(point.humidity, hour(5)["humidity"].as<float>());
+  EXPECT_FLOAT_EQ(point.pressure, hour(5)["pressure"].as<float>());
+  EXPECT_PACKED_VALUE(point.windSpeed, hour(5)["wind_speed"].as<float>());
+  EXPECT_PACKED_VALUE(point.precipProb, hour(5)["pop"].as<float>());
+}
+
+TEST_P(Lookup, BetweenHours) {
+  for (uint8_t i : {0, 5, 46}) {
+    SCOPED_TRACE(i);
+    OWMPoint point;
+    ASSERT_TRUE(owm.forecastAt(hourTime(i) + 900, point));
+    EXPECT_EQ(owm.hourAt(hourTime(i) + 900), i);
+    EXPECT_TRUE(point.hourly);
+
+    // A quarter of the way to the next hour
+    auto quarter = [&](const char *key) {
+      return hour(i)[key].as<float>() * 0.75f + hour(i + 1)[key].as<float>() * 0.25f;
+    };
+    EXPECT_NEAR(point.temp, quarter("temp"), 0.01);
+    EXPECT_NEAR(point.dewPoint, quarter("dew_point"), 0.01);
+    EXPECT_NEAR(point.humidity, quarter("humidity"), 0.01);
+    EXPECT_NEAR(point.pressure, quarter("pressure"), 0.01);
+    EXPECT_NEAR(point.clouds, quarter("clouds"), 0.01);
+    EXPECT_NEAR(point.windGust, quarter("wind_gust"), 0.01);
+    EXPECT_NEAR(point.precipProb, quarter("pop"), 0.01);
+
+    // Totals for the hour are not interpolated
+    EXPECT_PACKED_VALUE(point.rain, hour(i)["rain"]["1h"].as<float>());
+    EXPECT_PACKED_VALUE(point.snow, hour(i)["snow"]["1h"].as<float>());
+  }
+
+  // The last hour has nothing after it and keeps its own values
+  OWMPoint point;
+  ASSERT_TRUE(owm.forecastAt(hourTime(47) + 1800, point));
+  EXPECT_TRUE(point.hourly);
+  EXPECT_PACKED_VALUE(point.temp, hour(47)["temp"].as<float>());
+}
+
+TEST_P(Lookup, DailyPastTheHours) {
+  uint32_t after = hourTime(47) + 3600;
+  EXPECT_EQ(owm.hourAt(after), -1);
+  ASSERT_GE(owm.dayAt(after), 0);
+
+  // Day 4 at 6:00, 9:00 and 18:00 local time
+  const uint8_t i = 4;
+  OWMPoint point;
+  ASSERT_TRUE(owm.forecastAt(midnight(i) + 6 * 3600, point));
+  EXPECT_FALSE(point.hourly);
+  EXPECT_PACKED_VALUE(point.temp, day(i)["temp"]["morn"].as<float>());
+  EXPECT_PACKED_VALUE(point.feelsLike, day(i)["feels_like"]["morn"].as<float>());
+  EXPECT_FLOAT_EQ(point.humidity, day(i)["humidity"].as<float>());
+  EXPECT_PACKED_VALUE(point.windSpeed, day(i)["wind_speed"].as<float>());
+  EXPECT_NEAR(point.rain, day(i)["rain"].as<float>() / 24, 0.001);
+
+  ASSERT_TRUE(owm.forecastAt(midnight(i) + 9 * 3600, point));
+  EXPECT_NEAR(point.temp, (day(i)["temp"]["morn"].as<float>() + day(i)["temp"]["day"].as<float>()) / 2, 0.01);
+
+  ASSERT_TRUE(owm.forecastAt(midnight(i) + 18 * 3600, point));
+  EXPECT_PACKED_VALUE(point.temp, day(i)["temp"]["eve"].as<float>());
+
+  // Late evening runs towards the night temperature
+  ASSERT_TRUE(owm.forecastAt(midnight(i) + 21 * 3600, point));
+  EXPECT_NEAR(point.temp, (day(i)["temp"]["eve"].as<float>() + day(i)["temp"]["night"].as<float>()) / 2, 0.01);
+}
+
+TEST_P(Lookup, OutsideTheForecast) {
+  OWMPoint point;
+
+  // Before the first hour but on the first day the daily forecast is used
+  EXPECT_EQ(owm.hourAt(hourTime(0) - 1), -1);
+  EXPECT_EQ(owm.dayAt(hourTime(0) - 1), 0);
+  EXPECT_TRUE(owm.forecastAt(hourTime(0) - 1, point));
+  EXPECT_FALSE(point.hourly);
+
+  // Before the first day and after the last nothing is found
+  for (uint32_t time : {0u, midnight(0) - 1, midnight(7) + 86400, UINT32_MAX}) {
+    SCOPED_TRACE(time);
+    EXPECT_EQ(owm.hourAt(time), -1);
+    EXPECT_EQ(owm.dayAt(time), -1);
+    EXPECT_FALSE(owm.forecastAt(time, point));
+  }
+  EXPECT_EQ(owm.dayAt(midnight(7) + 86399), 7);
+
+  // Nothing stored
+  OWMOneCall empty;
+  ASSERT_TRUE(empty.begin("key", 1, 0, 48, 8, STANDARD));
+  EXPECT_EQ(empty.hourAt(hourTime(5)), -1);
+  EXPECT_EQ(empty.dayAt(hourTime(5)), -1);
+  EXPECT_FALSE(empty.forecastAt(hourTime(5), point));
+}
+
+TEST_P(Lookup, DaysFollowTheTimeZone) {
+  // Days start at local midnight, five hours after midnight UTC at -18000
+  ASSERT_EQ(oracle()["timezone_offset"].as<int32_t>(), -18000);
+  EXPECT_EQ(midnight(2) % 86400, 18000u);
+  EXPECT_EQ(owm.dayAt(midnight(2)), 2);
+  EXPECT_EQ(owm.dayAt(midnight(2) - 1), 1);
+
+  OWMPoint point;
+  ASSERT_TRUE(owm.forecastAt(midnight(5), point));
+  EXPECT_PACKED_VALUE(point.temp, day(5)["temp"]["night"].as<float>());
+
+  // The same response in UTC: 1:00 UTC is already the next day
+  std::string utc = response;
+  const char *offset = "\"timezone_offset\": -18000";
+  utc.replace(utc.find(offset), strlen(offset), "\"timezone_offset\": 0");
+  OWMOneCall other;
+  ASSERT_TRUE(parse(other, utc));
+  uint32_t time = midnight(2) - 4 * 3600;
+  EXPECT_EQ(owm.dayAt(time), 1);
+  EXPECT_EQ(other.dayAt(time), 2);
+
+  // Hours are not affected
+  EXPECT_EQ(other.hourAt(hourTime(5)), 5);
+}
+
+INSTANTIATE_TEST_SUITE_P(Storage, Lookup, ::testing::Values(STORE_RECORDS, STORE_SERIES),
+                         [](const ::testing::TestParamInfo<OWMStorage> &info) {
+                           return std::string(info.param == STORE_RECORDS ? "Records" : "Series");
+                         });
+
+}  // namespace
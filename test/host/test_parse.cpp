@@ -0,0 +1,305 @@
+/*
+  Parsing the checked-in responses: every mode must store exactly what the response holds, and
+  the document and streaming parsers, the record and series storage and poll() must agree on the
+  same fixture.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <Oracle.h>
+#include <vector>
+
+namespace {
+
+const uint8_t ALERTS = 2;
+const uint16_t ALERT_TEXT = 120;
+
+struct Config {
+  uint8_t min, hr, dly;
+};
+
+std::vector<uint8_t> encoded(OWMOneCall &owm) {
+  std::vector<uint8_t> data(owm.encodeForecast(NULL, 0));
+  owm.encodeForecast(data.data(), data.size());
+  return data;
+}
+
+// Parse a fixture with the given settings, step > 0 delivers it a few bytes at a time.  Alerts
+// are only asked for in streaming mode, as with alerts document mode streams too
+bool parse(OWMOneCall &owm, const std::string &response, const Config &config, bool streaming,
+           OWMStorage storage = STORE_RECORDS, size_t step = 0) {
+  owm.setAlerts(streaming ? ALERTS : 0, ALERT_TEXT);
+  owm.setHourlyStorage(storage);
+  owm.setStreaming(streaming);
+  if (!owm.begin("key", 1, config.min, config.hr, config.dly, STANDARD)) return false;
+  owm.setLocation(33.44, -94.04);
+  StringStream input(response, step);
+  return owm.parseWeather(input);
+}
+
+class ParseModes : public ::testing::TestWithParam<const char *> {};
+
+TEST_P(ParseModes, DocumentStoresTheResponse) {
+  std::string response = loadFixture(GetParam());
+  ForecastOracle oracle(response);
+  OWMOneCall owm;
+
+  ASSERT_TRUE(parse(owm, response, {60, 48, 8}, false));
+  oracle.expectForecast(owm, 60, 48, 8);
+  EXPECT_EQ(owm.alertCount, 0);
+}
+
+TEST_P(ParseModes, StreamingStoresTheResponse) {
+  std::string response = loadFixture(GetParam());
+  ForecastOracle oracle(response);
+  OWMOneCall owm;
+
+  ASSERT_TRUE(parse(owm, response, {60, 48, 8}, true, STORE_RECORDS, 97));
+  oracle.expectForecast(owm, 60, 48, 8);
+  oracle.expectAlerts(owm, ALERTS, ALERT_TEXT);
+}
+
+TEST_P(ParseModes, StreamingMatchesDocument) {
+  std::string response = loadFixture(GetParam());
+  const Config configs[] = {{60, 48, 8}, {0, 48, 8}, {0, 12, 3}, {5, 0, 1}};
+
+  for (const Config &config : configs) {
+    SCOPED_TRACE(testing::Message() << (int)config.min << "/" << (int)config.hr << "/" << (int)config.dly);
+    OWMOneCall document, streaming;
+    ASSERT_TRUE(parse(document, response, config, false));
+    ASSERT_TRUE(parse(streaming, response, config, true, STORE_RECORDS, 13));
+    EXPECT_EQ(encoded(document), encoded(streaming));
+    expectSameDerived(streaming.derived, document.derived);
+  }
+}
+
+TEST_P(ParseModes, SeriesMatchRecords) {
+  std::string response = loadFixture(GetParam());
+  ForecastOracle oracle(response);
+
+  for (bool streaming : {false, true}) {
+    SCOPED_TRACE(streaming ? "streaming" : "document");
+    OWMOneCall both, series;
+    ASSERT_TRUE(parse(both, response, {0, 48, 8}, streaming, STORE_BOTH));
+    oracle.expectHours(both.hrWx, 48);
+    oracle.expectSeries(both.hrSeries, 48);
+
+    ASSERT_TRUE(parse(series, response, {0, 48, 8}, streaming, STORE_SERIES));
+    EXPECT_EQ(series.hrWx, nullptr);
+    oracle.expectSeries(series.hrSeries, 48);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Fixtures, ParseModes, ::testing::Values("full.json", "compact.json", "localized.json"),
+                         [](const ::testing::TestParamInfo<const char *> &info) {
+                           return std::string(info.param).substr(0, std::string(info.param).find('.'));
+                         });
+
+TEST(Parse, FewerEntriesThanSent) {
+  std::string response = loadFixture("full.json");
+  ForecastOracle oracle(response);
+
+  for (bool streaming : {false, true}) {
+    OWMOneCall owm;
+    ASSERT_TRUE(parse(owm, response, {0, 12, 3}, streaming));
+    oracle.expectForecast(owm, 0, 12, 3);
+    EXPECT_EQ(owm.minWx, nullptr);
+  }
+}
+
+TEST(Parse, StorageChangedAfterBegin) {
+  std::string response = loadFixture("full.json");
+  ForecastOracle oracle(response);
+
+  for (bool streaming : {false, true}) {
+    SCOPED_TRACE(streaming ? "streaming" : "document");
+    OWMOneCall owm;
+    ASSERT_TRUE(parse(owm, response, {0, 48, 8}, streaming));
+    owm.setHourlyStorage(STORE_SERIES);
+
+    // The records allocated by begin() are still used until it is called again
+    StringStream input(response);
+    ASSERT_TRUE(owm.parseWeather(input));
+    oracle.expectHours(owm.hrWx, 48);
+    EXPECT_EQ(owm.hrSeries.count, 0);
+
+    ASSERT_TRUE(owm.begin("key", 1, 0, 48, 8, STANDARD));
+    input.rewind();
+    ASSERT_TRUE(owm.parseWeather(input));
+    EXPECT_EQ(owm.hrWx, nullptr);
+    oracle.expectSeries(owm.hrSeries, 48);
+  }
+}
+
+TEST(Parse, DoubleBufferChangedAfterBegin) {
+  std::string response = loadFixture("full.json");
+  ForecastOracle oracle(response);
+  OWMOneCall owm;
+
+  ASSERT_TRUE(parse(owm, response, {60, 48, 8}, false));
+  owm.setDoubleBuffer(true);
+  StringStream input(response);
+  ASSERT_TRUE(owm.parseWeather(input));
+  EXPECT_EQ(owm.getForecast(), &owm);
+
+  // begin() sets aside the second forecast, which the next update fills and publishes
+  ASSERT_TRUE(owm.begin("key", 1, 60, 48, 8, STANDARD));
+  input.rewind();
+  ASSERT_TRUE(owm.parseWeather(input));
+  ASSERT_NE(owm.getForecast(), &owm);
+  oracle.expectForecast(*owm.getForecast(), 60, 48, 8);
+}
+
+TEST(Parse, CurrentOnly) {
+  std::string response = loadFixture("minimal.json");
+  ForecastOracle oracle(response);
+
+  for (bool streaming : {false, true}) {
+    OWMOneCall owm;
+    ASSERT_TRUE(parse(owm, response, {0, 0, 0}, streaming));
+    oracle.expectForecast(owm, 0, 0, 0);
+  }
+}
+
+TEST(Parse, LocalizedText) {
+  std::string response = loadFixture("localized.json");
+  OWMOneCall owm;
+
+  ASSERT_TRUE(parse(owm, response, {0, 48, 8}, true));
+  EXPECT_STREQ(owm.hrWx[4].main, expectedText(ForecastOracle(response)["hourly"][4]["weather"][0], "main").c_str());
+#ifndef OWM_PACKED_FORECAST
+  EXPECT_STREQ(owm.hrWx[4].main, "Nebel");
+  EXPECT_STREQ(owm.hrWx[10].description, "leichter Regen");
+#endif
+}
+
+TEST(Parse, UnknownConditionId) {
+  packedHourlyWeather packed = packedHourlyWeather();
+  EXPECT_EQ(packed.id, 0);
+  packed.id = 600;
+  EXPECT_EQ(packed.id, 600);
+  EXPECT_STREQ(packed.main, "Snow");
+  EXPECT_STREQ(packed.description, "light snow");
+  packed.id = 999;
+  EXPECT_EQ(packed.id, OWM_CONDITION_ID_UNKNOWN);
+  EXPECT_STREQ(packed.main, "");
+  EXPECT_STREQ(packed.description, "");
+
+  // Hour 3 is light snow (600) and hour 4 mist (701)
+  std::string response = loadFixture("full.json");
+  size_t pos = response.find("\"hourly\"");
+  for (int i = 0; i < 4; i++) pos = response.find("\"weather\"", pos + 1);
+  pos = response.find("600", pos);
+  response.replace(pos, 3, "999");
+
+  for (bool streaming : {false, true}) {
+    SCOPED_TRACE(streaming ? "streaming" : "document");
+    OWMOneCall owm;
+    ASSERT_TRUE(parse(owm, response, {0, 48, 8}, streaming));
+#ifdef OWM_PACKED_FORECAST
+    EXPECT_EQ(owm.hrWx[3].id, OWM_CONDITION_ID_UNKNOWN);
+    EXPECT_STREQ(owm.hrWx[3].main, "");
+#else
+    EXPECT_EQ(owm.hrWx[3].id, 999);
+    EXPECT_STREQ(owm.hrWx[3].main, "Snow");
+#endif
+    EXPECT_EQ(owm.hrWx[4].id, 701);
+  }
+}
+
+TEST(Parse, IconCodes) {
+  const struct {
+    const char *code;
+    Icon icon;
+  } icons[] = {
+    {"01d", i01d}, {"01n", i01n}, {"02d", i02d}, {"02n", i02n}, {"03d", i03d}, {"03n", i03n},
+    {"04d", i04d}, {"04n", i04n}, {"09d", i09d}, {"09n", i09n}, {"10d", i10d}, {"10n", i10n},
+    {"11d", i11d}, {"11n", i11n}, {"13d", i13d}, {"13n", i13n}, {"50d", i50d}, {"50n", i50n},
+    {"05d", ierr}, {"01x", ierr}, {"1d", ierr}, {"010d", ierr}, {"99n", ierr}, {"", ierr},
+  };
+  std::string fixture = loadFixture("minimal.json");
+  size_t pos = fixture.find("\"03d\"") + 1;
+
+  for (const auto &expected : icons) {
+    SCOPED_TRACE(expected.code);
+    std::string response = fixture;
+    response.replace(pos, 3, expected.code);
+    for (bool streaming : {false, true}) {
+      OWMOneCall owm;
+      ASSERT_TRUE(parse(owm, response, {0, 0, 0}, streaming));
+      EXPECT_EQ(owm.currWx.ico, expected.icon);
+    }
+  }
+}
+
+TEST(Parse, NullValuesAreSkipped) {
+  std::string response = loadFixture("minimal.json");
+  for (const char *value : {"\"America/Chicago\"", "292.55", "\"Clouds\""}) {
+    response.replace(response.find(value), strlen(value), "null");
+  }
+
+  for (bool streaming : {false, true}) {
+    SCOPED_TRACE(streaming ? "streaming" : "document");
+    OWMOneCall owm;
+    ASSERT_TRUE(parse(owm, response, {0, 0, 0}, streaming));
+    EXPECT_STREQ(owm.timeZone.c_str(), "");
+    EXPECT_EQ(owm.currWx.temp, 0);
+    EXPECT_STREQ(owm.currWx.main, "");
+    EXPECT_STREQ(owm.currWx.description, "scattered clouds");
+  }
+}
+
+TEST(Parse, BrokenResponseFails) {
+  std::string response = loadFixture("full.json");
+
+  for (bool streaming : {false, true}) {
+    OWMOneCall owm;
+    owm.setTimeout(100);  // How long the stream parser waits for the rest
+    EXPECT_FALSE(parse(owm, response.substr(0, response.size() / 2), {60, 48, 8}, streaming));
+    EXPECT_FALSE(parse(owm, "{\"current\": [1, 2", {60, 48, 8}, streaming));
+    EXPECT_FALSE(parse(owm, "", {60, 48, 8}, streaming));
+  }
+}
+
+TEST(Parse, AlertsAreStreamed) {
+  std::string response = loadFixture("full.json");
+  ForecastOracle oracle(response);
+  OWMOneCall owm;
+
+  owm.setAlerts(ALERTS, ALERT_TEXT);
+  ASSERT_TRUE(owm.begin("key", 1, 0, 48, 8, STANDARD));
+  StringStream input(response);
+  ASSERT_TRUE(owm.parseWeather(input));
+  EXPECT_EQ(owm.getJsonMemory(), 0u);
+  oracle.expectForecast(owm, 0, 48, 8);
+  oracle.expectAlerts(owm, ALERTS, ALERT_TEXT);
+}
+
+TEST(Parse, LongestAlertText) {
+  std::string response = loadFixture("full.json");
+  OWMOneCall owm;
+
+  owm.setAlerts(ALERTS, UINT16_MAX);
+  ASSERT_TRUE(owm.begin("key", 1, 0, 0, 0, STANDARD));
+  StringStream input(response);
+  ASSERT_TRUE(owm.parseWeather(input));
+  ForecastOracle(response).expectAlerts(owm, ALERTS, UINT16_MAX);
+}
+
+TEST(Parse, DocumentMemoryIsTracked) {
+  std::string response = loadFixture("full.json");
+  OWMOneCall owm;
+
+  ASSERT_TRUE(parse(owm, response, {60, 48, 8}, false));
+  size_t full = owm.getJsonMemory();
+  EXPECT_GT(full, 0u);
+  EXPECT_GT(owm.getJsonAllocations(), 0u);
+
+  ASSERT_TRUE(parse(owm, response, {0, 12, 3}, false));
+  EXPECT_LT(owm.getJsonMemory(), full);  // The filter drops the sections not requested
+
+  ASSERT_TRUE(parse(owm, response, {60, 48, 8}, true));
+  EXPECT_EQ(owm.getJsonMemory(), 0u);
+}
+
+}  // namespace
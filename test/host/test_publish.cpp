@@ -0,0 +1,174 @@
+/*
+  Publishing forecasts to a reader with getSequence(), getForecast() and forecastIntact().  The
+  reader runs at chosen points of an update, called from the stream the update reads.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <Oracle.h>
+#include <functional>
+
+namespace {
+
+// Calls reader once, when at bytes of the response have been read
+class ReaderStream : public StringStream
+{
+private:
+    size_t _at;
+    std::function<void()> _reader;
+
+    void check() {
+      if (_reader && position() >= _at) {
+        std::function<void()> reader = _reader;
+        _reader = nullptr;
+        reader();
+      }
+    }
+
+public:
+    ReaderStream(const std::string &text, size_t at, std::function<void()> reader)
+      : StringStream(text, 64), _at(at), _reader(reader) {}
+
+    int read() override {
+      int c = StringStream::read();
+      check();
+      return c;
+    }
+    size_t readBytes(char *buffer, size_t length) override {
+      size_t n = StringStream::readBytes(buffer, length);
+      check();
+      return n;
+    }
+};
+
+class Publish : public ::testing::TestWithParam<bool>
+{
+protected:
+    OWMOneCall owm;
+    std::string first, second, third;
+
+    void SetUp() override {
+      // The same response with three current temperatures
+      first = loadFixture("full.json");
+      second = withTemp(first, "301.00");
+      third = withTemp(first, "302.00");
+
+      owm.setStreaming(true);
+      owm.setDoubleBuffer(GetParam());
+      ASSERT_TRUE(owm.begin("key", 1, 0, 48, 8, STANDARD));
+      owm.setLocation(33.44, -94.04);
+      ASSERT_TRUE(update(first));
+    }
+
+    static std::string withTemp(std::string text, const char *temp) {
+      const char *current = "\"temp\": 292.55";
+      text.replace(text.find(current), strlen(current), std::string("\"temp\": ") + temp);
+      return text;
+    }
+
+    bool update(const std::string &response) {
+      StringStream input(response, 64);
+      return owm.parseWeather(input);
+    }
+
+    // Update, running reader halfway through the response
+    bool update(const std::string &response, std::function<void()> reader) {
+      ReaderStream input(response, response.size() / 2, reader);
+      return owm.parseWeather(input);
+    }
+};
+
+TEST_P(Publish, NoUpdateWhileReading) {
+  uint32_t sequence = owm.getSequence();
+  EXPECT_EQ(sequence & 1, 0u);
+  const OWMForecast *wx = owm.getForecast();
+  EXPECT_FLOAT_EQ(wx->currWx.temp, 292.55f);
+  EXPECT_TRUE(owm.forecastIntact(sequence));
+}
+
+TEST_P(Publish, OneUpdateWhileReading) {
+  uint32_t sequence = owm.getSequence();
+  const OWMForecast *wx = owm.getForecast();
+  ASSERT_TRUE(update(second));
+
+  // With double buffering the forecast read is kept and the next one published beside it
+  EXPECT_EQ(owm.forecastIntact(sequence), GetParam());
+  if (GetParam()) {
+    EXPECT_FLOAT_EQ(wx->currWx.temp, 292.55f);
+    EXPECT_NE(owm.getForecast(), wx);
+  }
+  EXPECT_FLOAT_EQ(owm.getForecast()->currWx.temp, 301.0f);
+}
+
+TEST_P(Publish, TwoUpdatesWhileReading) {
+  uint32_t sequence = owm.getSequence();
+  const OWMForecast *wx = owm.getForecast();
+  ASSERT_TRUE(update(second));
+  ASSERT_TRUE(update(third));
+
+  // The second update wrote over the forecast read either way
+  EXPECT_FALSE(owm.forecastIntact(sequence));
+  EXPECT_EQ(owm.getForecast(), wx);
+  EXPECT_FLOAT_EQ(wx->currWx.temp, 302.0f);
+}
+
+TEST_P(Publish, UpdateStartsWhileReading) {
+  uint32_t sequence = owm.getSequence();
+  const OWMForecast *wx = owm.getForecast();
+
+  // An update that starts after the reader is only harmless with double buffering.  A single
+  // forecast is written in place, the current section already holds the new temperature
+  bool intact = false;
+  ASSERT_TRUE(update(second, [&]() {
+    intact = owm.forecastIntact(sequence);
+    EXPECT_FLOAT_EQ(wx->currWx.temp, GetParam() ? 292.55f : 301.0f);
+  }));
+  EXPECT_EQ(intact, GetParam());
+}
+
+TEST_P(Publish, ReaderStartsDuringAnUpdate) {
+  uint32_t sequence = 0;
+  const OWMForecast *wx = NULL;
+  float temp = 0;
+  bool intact = false;
+
+  ASSERT_TRUE(update(second, [&]() {
+    sequence = owm.getSequence();
+    wx = owm.getForecast();
+    temp = wx->currWx.temp;
+    intact = owm.forecastIntact(sequence);
+  }));
+
+  // Odd while the update is in progress.  A single forecast is being written, with double
+  // buffering the reader has the last one published
+  EXPECT_EQ(sequence & 1, 1u);
+  EXPECT_EQ(intact, GetParam());
+  if (!GetParam()) return;
+  EXPECT_FLOAT_EQ(temp, 292.55f);
+
+  // Still intact after the update it started in, overwritten once the next one starts
+  EXPECT_TRUE(owm.forecastIntact(sequence));
+  bool during = true;
+  ASSERT_TRUE(update(third, [&]() { during = owm.forecastIntact(sequence); }));
+  EXPECT_FALSE(during);
+  EXPECT_FALSE(owm.forecastIntact(sequence));
+}
+
+TEST_P(Publish, FailedUpdateKeepsThePublishedForecast) {
+  uint32_t sequence = owm.getSequence();
+  const OWMForecast *wx = owm.getForecast();
+  owm.setTimeout(100);
+  EXPECT_FALSE(update(second.substr(0, second.size() / 2)));
+
+  // Nothing new is published, so with double buffering the reader is not overtaken
+  EXPECT_EQ(owm.getForecast(), wx);
+  EXPECT_EQ(owm.getSequence(), sequence + 2);
+  EXPECT_EQ(owm.forecastIntact(sequence), GetParam());
+}
+
+INSTANTIATE_TEST_SUITE_P(Buffers, Publish, ::testing::Bool(),
+                         [](const ::testing::TestParamInfo<bool> &info) {
+                           return std::string(info.param ? "Double" : "Single");
+                         });
+
+}  // namespace
@@ -0,0 +1,111 @@
+/*
+  Statistics over the hourly series, checked against values worked out from full.json.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <Oracle.h>
+
+namespace {
+
+class Series : public ::testing::Test
+{
+protected:
+    OWMOneCall owm;
+
+    void SetUp() override {
+      owm.setHourlyStorage(STORE_SERIES);
+      ASSERT_TRUE(owm.begin("key", 1, 0, 48, 8, STANDARD));
+      owm.setLocation(33.44, -94.04);
+      StringStream input(loadFixture("full.json"));
+      ASSERT_TRUE(owm.parseWeather(input));
+      ASSERT_EQ(owm.hrSeries.count, 48);
+    }
+};
+
+TEST_F(Series, Temperature) {
+  const float *temp = owm.hrSeries.temp;
+
+  // All 48 hours
+  EXPECT_FLOAT_EQ(owmSeriesMin(temp, 0, 48), 280.07f);
+  EXPECT_FLOAT_EQ(owmSeriesMax(temp, 0, 48), 299.47f);
+  EXPECT_NEAR(owmSeriesSum(temp, 0, 48), 13941.92f, 0.01);
+  EXPECT_NEAR(owmSeriesMean(temp, 0, 48), 290.4567f, 0.0001);
+  EXPECT_EQ(owmSeriesArgMin(temp, 0, 48), 36);
+  EXPECT_EQ(owmSeriesArgMax(temp, 0, 48), 45);
+
+  // The first day
+  EXPECT_FLOAT_EQ(owmSeriesMin(temp, 0, 24), 280.78f);
+  EXPECT_FLOAT_EQ(owmSeriesMax(temp, 0, 24), 299.4f);
+  EXPECT_NEAR(owmSeriesMean(temp, 0, 24), 290.6937f, 0.0001);
+  EXPECT_EQ(owmSeriesArgMin(temp, 0, 24), 14);
+  EXPECT_EQ(owmSeriesArgMax(temp, 0, 24), 18);
+
+  // Hours 5 to 11, not a multiple of the four accumulators
+  EXPECT_FLOAT_EQ(owmSeriesMin(temp, 5, 7), 285.37f);
+  EXPECT_FLOAT_EQ(owmSeriesMax(temp, 5, 7), 294.09f);
+  EXPECT_NEAR(owmSeriesSum(temp, 5, 7), 2032.76f, 0.01);
+  EXPECT_NEAR(owmSeriesMean(temp, 5, 7), 290.3943f, 0.0001);
+  EXPECT_EQ(owmSeriesArgMin(temp, 5, 7), 6);
+  EXPECT_EQ(owmSeriesArgMax(temp, 5, 7), 8);
+
+  // Only the last hour
+  EXPECT_FLOAT_EQ(owmSeriesMin(temp, 47, 1), 285.08f);
+  EXPECT_FLOAT_EQ(owmSeriesMax(temp, 47, 1), 285.08f);
+  EXPECT_FLOAT_EQ(owmSeriesMean(temp, 47, 1), 285.08f);
+  EXPECT_EQ(owmSeriesArgMax(temp, 47, 1), 47);
+}
+
+TEST_F(Series, RainAndProbability) {
+  // Hours without rain are 0
+  EXPECT_FLOAT_EQ(owmSeriesMin(owm.hrSeries.rain, 0, 48), 0);
+  EXPECT_FLOAT_EQ(owmSeriesMax(owm.hrSeries.rain, 0, 48), 3.93f);
+  EXPECT_NEAR(owmSeriesSum(owm.hrSeries.rain, 0, 48), 46.33f, 0.001);
+  EXPECT_NEAR(owmSeriesSum(owm.hrSeries.rain, 0, 3), 3.36f, 0.001);
+  EXPECT_NEAR(owmSeriesMean(owm.hrSeries.rain, 0, 3), 1.12f, 0.001);
+  EXPECT_EQ(owmSeriesArgMin(owm.hrSeries.rain, 0, 48), 0);
+  EXPECT_EQ(owmSeriesArgMax(owm.hrSeries.rain, 0, 48), 24);
+
+  EXPECT_FLOAT_EQ(owmSeriesMin(owm.hrSeries.precipProb, 10, 13), 0.08f);
+  EXPECT_FLOAT_EQ(owmSeriesMax(owm.hrSeries.precipProb, 10, 13), 0.89f);
+  EXPECT_NEAR(owmSeriesMean(owm.hrSeries.precipProb, 10, 13), 0.4908f, 0.0001);
+  EXPECT_EQ(owmSeriesArgMin(owm.hrSeries.precipProb, 10, 13), 12);
+  EXPECT_EQ(owmSeriesArgMax(owm.hrSeries.precipProb, 10, 13), 19);
+}
+
+TEST_F(Series, Empty) {
+  // No hours of a stored series
+  const float *temp = owm.hrSeries.temp;
+  EXPECT_EQ(owmSeriesMin(temp, 0, 0), 0);
+  EXPECT_EQ(owmSeriesMax(temp, 0, 0), 0);
+  EXPECT_EQ(owmSeriesSum(temp, 0, 0), 0);
+  EXPECT_EQ(owmSeriesMean(temp, 0, 0), 0);
+  EXPECT_EQ(owmSeriesArgMin(temp, 10, 0), 10);
+  EXPECT_EQ(owmSeriesArgMax(temp, 10, 0), 10);
+
+  // Series storage off: the arrays are not allocated and count is 0
+  OWMOneCall records;
+  ASSERT_TRUE(records.begin("key", 1, 0, 48, 8, STANDARD));
+  const hourlySeries &none = records.hrSeries;
+  ASSERT_EQ(none.count, 0);
+  ASSERT_EQ(none.temp, nullptr);
+  EXPECT_EQ(owmSeriesMin(none.temp, 0, none.count), 0);
+  EXPECT_EQ(owmSeriesMax(none.temp, 0, none.count), 0);
+  EXPECT_EQ(owmSeriesSum(none.temp, 0, none.count), 0);
+  EXPECT_EQ(owmSeriesMean(none.temp, 0, none.count), 0);
+  EXPECT_EQ(owmSeriesArgMin(none.temp, 0, none.count), 0);
+  EXPECT_EQ(owmSeriesArgMax(none.temp, 0, none.count), 0);
+}
+
+TEST(SeriesEdges, LastPosition) {
+  // A range ending at the last position a uint8_t can hold
+  float values[256] = {};
+  values[254] = 2;
+  values[255] = 1;
+  EXPECT_EQ(owmSeriesArgMax(values, 255, 1), 255);
+  EXPECT_EQ(owmSeriesArgMax(values, 250, 6), 254);
+  EXPECT_EQ(owmSeriesArgMin(values, 254, 2), 255);
+  EXPECT_FLOAT_EQ(owmSeriesSum(values, 250, 6), 3);
+}
+
+}  // namespace
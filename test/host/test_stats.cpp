@@ -0,0 +1,95 @@
+/*
+  Request statistics.
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <MockServer.h>
+#include <Oracle.h>
+
+namespace {
+
+TEST(Stats, CountsRequestsAndFailures) {
+  MockServer server;
+  WiFiClient::redirect("127.0.0.1", server.port());
+  MockResponse ok;
+  ok.body = loadFixture("full.json");
+  server.queue(ok);
+  server.queue(ok);
+  MockResponse failed = ok;
+  failed.truncate = ok.body.size() / 2;
+  server.respond(failed);
+
+  OWMOneCall owm;
+  owm.setTimeout(1000);
+  ASSERT_TRUE(owm.begin("key", 1, 60, 48, 8, STANDARD));
+  owm.setLocation(33.44, -94.04);
+  EXPECT_TRUE(owm.getWeather());
+  EXPECT_TRUE(owm.getWeather());
+  EXPECT_FALSE(owm.getWeather());
+
+  const OWMStats &stats = owm.getStats();
+  EXPECT_EQ(stats.requests, 3u);
+  EXPECT_EQ(stats.failures, 1u);
+  EXPECT_EQ(stats.httpCode, 200);
+  EXPECT_EQ(stats.error, OWM_ERROR_PARSE);
+  EXPECT_GT(stats.minFreeHeap, 0u);
+  EXPECT_LE(stats.minFreeHeap, ESP.getHeapSize());
+  uint32_t counted = 0;
+  for (uint8_t i = 0; i < OWM_STATS_BUCKETS; i++) counted += stats.histogram[i];
+  EXPECT_EQ(counted, 3u);
+
+  owm.resetStats();
+  EXPECT_EQ(owm.getStats().requests, 0u);
+  owm.disconnect();
+  WiFiClient::redirect(NULL, 0);
+}
+
+TEST(Stats, LookupAndConnectTimes) {
+  MockServer server;
+  WiFiClient::redirect("127.0.0.1", server.port());
+  MockResponse ok;
+  ok.body = loadFixture("minimal.json");
+  server.respond(ok);
+  WiFiClass::setLookupDelay(50);
+
+  WiFiClient client;
+  OWMClientTransport clientTransport(client);
+  for (OWMTransport *transport : {(OWMTransport *)NULL, (OWMTransport *)&clientTransport}) {
+    SCOPED_TRACE(transport ? "client" : "HTTPClient");
+    OWMOneCall owm;
+    owm.setTransport(transport);
+    ASSERT_TRUE(owm.begin("key", 1, 0, 0, 0, STANDARD));
+    owm.setLocation(33.44, -94.04);
+
+    // HTTPClient times the name lookup apart, the client transport counts it as connecting
+    ASSERT_TRUE(owm.getWeather());
+    const OWMStats &stats = owm.getStats();
+    if (transport) {
+      EXPECT_EQ(stats.lookupMs, 0u);
+      EXPECT_GE(stats.connectMs, 50u);
+    } else {
+      EXPECT_GE(stats.lookupMs, 50u);
+      EXPECT_LT(stats.connectMs, 50u);
+    }
+    EXPECT_LT(stats.firstByteMs, 50u);
+
+    // The connection kept open is used again
+    ASSERT_TRUE(owm.getWeather());
+    EXPECT_EQ(owm.getStats().lookupMs, 0u);
+    EXPECT_EQ(owm.getStats().connectMs, 0u);
+    owm.disconnect();
+  }
+  WiFiClass::setLookupDelay(0);
+  WiFiClient::redirect(NULL, 0);
+}
+
+TEST(Stats, Buckets) {
+  EXPECT_EQ(owmStatsBucket(0), 0);
+  EXPECT_EQ(owmStatsBucket(OWM_STATS_FIRST_MS - 1), 0);
+  EXPECT_EQ(owmStatsBucket(OWM_STATS_FIRST_MS), 1);
+  EXPECT_EQ(owmStatsBucket(OWM_STATS_FIRST_MS * 2), 2);
+  EXPECT_EQ(owmStatsBucket(UINT32_MAX), OWM_STATS_BUCKETS - 1);
+}
+
+}  // namespace
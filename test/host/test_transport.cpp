@@ -0,0 +1,313 @@
+/*
+  Requests through both transports to the loopback mock server: the stored forecast, connection
+  reuse, chunked responses, ETags, errors and poll().
+
+  Released under the MIT License, see OWMOneCall.h
+*/
+
+#include <MockServer.h>
+#include <Oracle.h>
+#include <vector>
+
+namespace {
+
+enum TransportKind { HTTP_CLIENT, CLIENT };
+
+std::vector<uint8_t> encoded(OWMOneCall &owm) {
+  std::vector<uint8_t> data(owm.encodeForecast(NULL, 0));
+  owm.encodeForecast(data.data(), data.size());
+  return data;
+}
+
+class Transport : public ::testing::TestWithParam<std::tuple<TransportKind, bool>>
+{
+protected:
+    MockServer server;
+    WiFiClient client;
+    OWMClientTransport clientTransport;
+    OWMOneCall owm;
+    std::string response;
+
+    Transport() : clientTransport(client) {}
+
+    void SetUp() override {
+      response = loadFixture("full.json");
+      WiFiClient::redirect("127.0.0.1", server.port());
+      MockResponse ok;
+      ok.body = response;
+      server.respond(ok);
+
+      if (std::get<0>(GetParam()) == CLIENT) owm.setTransport(&clientTransport);
+      owm.setStreaming(std::get<1>(GetParam()));
+      owm.setTimeout(1000);
+      owm.setAlerts(std::get<1>(GetParam()) ? 2 : 0, 120);  // Alerts are always streamed
+      ASSERT_TRUE(owm.begin("key", 1, 60, 48, 8, STANDARD));
+      owm.setLocation(33.44, -94.04);
+    }
+
+    void TearDown() override {
+      owm.disconnect();
+      WiFiClient::redirect(NULL, 0);
+    }
+};
+
+TEST_P(Transport, StoresTheResponse) {
+  ASSERT_TRUE(owm.getWeather());
+  ForecastOracle(response).expectForecast(owm, 60, 48, 8);
+  ForecastOracle(response).expectAlerts(owm, std::get<1>(GetParam()) ? 2 : 0, 120);
+
+  std::vector<std::string> requests = server.requests();
+  ASSERT_EQ(requests.size(), 1u);
+  EXPECT_EQ(requests[0].find("GET /data/3.0/onecall?APPID=key&lat=33.44&lon=-94.04"), 0u) << requests[0];
+  EXPECT_EQ(owm.getStats().error, OWM_ERROR_NONE);
+  EXPECT_EQ(owm.getStats().httpCode, 200);
+  if (std::get<1>(GetParam())) EXPECT_GT(owm.getStats().payloadBytes, 0u);
+  else EXPECT_EQ(owm.getStats().payloadBytes, response.size());
+}
+
+TEST_P(Transport, KeepAliveReusesTheConnection) {
+  for (int i = 0; i < 3; i++) ASSERT_TRUE(owm.getWeather()) << i;
+  EXPECT_EQ(server.requests().size(), 3u);
+  EXPECT_EQ(server.connections(), 1);
+  ForecastOracle(response).expectForecast(owm, 60, 48, 8);
+}
+
+TEST_P(Transport, ConnectionClosedWithoutKeepAlive) {
+  owm.setKeepAlive(false);
+  for (int i = 0; i < 3; i++) ASSERT_TRUE(owm.getWeather()) << i;
+  EXPECT_EQ(server.connections(), 3);
+}
+
+TEST_P(Transport, ServerClosingTheConnection) {
+  MockResponse closing;
+  closing.body = response;
+  closing.close = true;
+  server.respond(closing);
+
+  for (int i = 0; i < 2; i++) ASSERT_TRUE(owm.getWeather()) << i;
+  EXPECT_EQ(server.connections(), 2);
+}
+
+TEST_P(Transport, ChunkedResponse) {
+  MockResponse chunked;
+  chunked.body = response;
+  chunked.chunked = true;
+  chunked.chunkSize = 700;
+  server.respond(chunked);
+
+  for (int i = 0; i < 2; i++) ASSERT_TRUE(owm.getWeather()) << i;
+  ForecastOracle(response).expectForecast(owm, 60, 48, 8);
+  EXPECT_EQ(server.connections(), 1);
+}
+
+TEST_P(Transport, BodyReadPastTheJson) {
+  MockResponse trailing;
+  trailing.body = response + "\n";
+  trailing.pauseAt = response.size();  // The JSON is complete before the rest arrives
+  trailing.pauseMs = 200;
+  server.respond(trailing);
+
+  for (int i = 0; i < 2; i++) {
+    ASSERT_TRUE(owm.getWeather()) << i;
+    EXPECT_EQ(owm.getStats().error, OWM_ERROR_NONE);
+  }
+  ForecastOracle(response).expectForecast(owm, 60, 48, 8);
+  EXPECT_EQ(server.connections(), 1);
+}
+
+TEST_P(Transport, NotModifiedKeepsTheForecast) {
+  MockResponse tagged;
+  tagged.body = response;
+  tagged.headers.push_back("ETag: \"v1\"");
+  server.queue(tagged);
+  MockResponse notModified;
+  notModified.status = 304;
+  server.respond(notModified);
+
+  ASSERT_TRUE(owm.getWeather());
+  ASSERT_TRUE(owm.getWeather());
+  std::vector<std::string> requests = server.requests();
+  ASSERT_EQ(requests.size(), 2u);
+  EXPECT_EQ(requests[0].find("If-None-Match"), std::string::npos);
+  EXPECT_NE(requests[1].find("If-None-Match: \"v1\""), std::string::npos) << requests[1];
+  ForecastOracle(response).expectForecast(owm, 60, 48, 8);
+}
+
+TEST_P(Transport, HttpErrorKeepsTheForecast) {
+  MockResponse unauthorized;
+  unauthorized.status = 401;
+  unauthorized.body = "{\"cod\":401, \"message\": \"Invalid API key.\"}";
+  MockResponse ok;
+  ok.body = response;
+  server.queue(ok);
+  server.respond(unauthorized);
+
+  ASSERT_TRUE(owm.getWeather());
+  EXPECT_FALSE(owm.getWeather());
+  EXPECT_EQ(owm.getStats().httpCode, 401);
+  EXPECT_EQ(owm.getStats().error, OWM_ERROR_HTTP);
+  EXPECT_EQ(owm.getStats().failures, 1u);
+  ForecastOracle(response).expectForecast(owm, 60, 48, 8);
+}
+
+TEST_P(Transport, TruncatedResponseFails) {
+  MockResponse truncated;
+  truncated.body = response;
+  truncated.truncate = response.size() / 2;
+  server.respond(truncated);
+
+  EXPECT_FALSE(owm.getWeather());
+  EXPECT_NE(owm.getStats().error, OWM_ERROR_NONE);
+}
+
+TEST_P(Transport, RefusedConnectionFails) {
+  server.stop();
+  EXPECT_FALSE(owm.getWeather());
+  EXPECT_EQ(owm.getStats().error, OWM_ERROR_CONNECT);
+}
+
+TEST_P(Transport, ApiKeyMustFitTheCall) {
+  size_t fixed = strlen("http://api.openweathermap.org/data/3.0/onecall?units=metric&APPID=&lat=") +
+                 sizeof("-180.00&lon=-180.00&exclude=alerts,current,daily,hourly,minutely");
+  std::string key(OWM_API_CALL_SIZE - fixed, 'k');
+
+  EXPECT_FALSE(owm.begin((key + "k").c_str(), 1, 60, 48, 8, METRIC));
+  EXPECT_FALSE(owm.getWeather());
+  EXPECT_TRUE(server.requests().empty());
+
+  // The longest key that fits leaves room for any location
+  ASSERT_TRUE(owm.begin(key.c_str(), 1, 0, 0, 0, METRIC));
+  owm.setLocation(-89.99, -179.99);
+  ASSERT_TRUE(owm.getWeather());
+  std::vector<std::string> requests = server.requests();
+  ASSERT_EQ(requests.size(), 1u);
+  std::string excluded = std::get<1>(GetParam()) ? "daily,hourly,minutely " : "alerts,daily,hourly,minutely ";
+  EXPECT_NE(requests[0].find(key + "&lat=-89.99&lon=-179.99&exclude=" + excluded), std::string::npos) << requests[0];
+}
+
+TEST_P(Transport, EveryLocationOverOneConnection) {
+  ASSERT_GE(owm.addLocation(51.5, -0.12), 0);
+  ASSERT_GE(owm.addLocation(-33.9, 151.2), 0);
+
+  EXPECT_EQ(owm.getWeatherAll(), 2);
+  EXPECT_EQ(server.connections(), 1);
+  for (uint8_t slot = 0; slot < 2; slot++) {
+    ASSERT_NE(owm.getLocation(slot), nullptr);
+    EXPECT_TRUE(owm.getLocation(slot)->updated);
+    ForecastOracle(response).expectForecast(owm.getLocation(slot)->forecast, 60, 48, 8);
+  }
+}
+
+TEST_P(Transport, GetWeatherAllCountsTheLocationsUpdated) {
+  MockResponse ok;
+  ok.body = response;
+  MockResponse unauthorized;
+  unauthorized.status = 401;
+  server.queue(ok);
+  server.queue(unauthorized);
+  ASSERT_EQ(owm.addLocation(51.5, -0.12), 0);
+  ASSERT_EQ(owm.addLocation(-33.9, 151.2), 1);
+  ASSERT_EQ(owm.addLocation(40.71, -74.01), 2);
+  owm.removeLocation(1);
+  ASSERT_EQ(owm.addLocation(35.68, 139.69), 1);
+
+  EXPECT_EQ(owm.getWeatherAll(), 2);
+  std::vector<std::string> requests = server.requests();
+  ASSERT_EQ(requests.size(), 3u);
+  EXPECT_NE(requests[0].find("lat=51.50&lon=-0.12"), std::string::npos) << requests[0];
+  EXPECT_NE(requests[1].find("lat=35.68&lon=139.69"), std::string::npos) << requests[1];
+  EXPECT_NE(requests[2].find("lat=40.71&lon=-74.01"), std::string::npos) << requests[2];
+  EXPECT_TRUE(owm.getLocation(0)->updated);
+  EXPECT_FALSE(owm.getLocation(1)->updated);
+  EXPECT_TRUE(owm.getLocation(2)->updated);
+  ForecastOracle(response).expectForecast(owm.getLocation(2)->forecast, 60, 48, 8);
+}
+
+std::vector<std::pair<int8_t, bool>> finished;
+
+void recordFinished(int8_t slot, bool updated) {
+  finished.push_back(std::make_pair(slot, updated));
+}
+
+TEST_P(Transport, StartWeatherAllPollsEveryLocation) {
+  MockResponse ok;
+  ok.body = response;
+  MockResponse unauthorized;
+  unauthorized.status = 401;
+  server.queue(ok);
+  server.queue(unauthorized);
+  EXPECT_FALSE(owm.startWeatherAll());  // No locations added
+  ASSERT_EQ(owm.addLocation(51.5, -0.12), 0);
+  ASSERT_EQ(owm.addLocation(-33.9, 151.2), 1);
+  ASSERT_EQ(owm.addLocation(40.71, -74.01), 2);
+
+  finished.clear();
+  owm.setCallback(recordFinished);
+  ASSERT_TRUE(owm.startWeatherAll());
+  EXPECT_FALSE(owm.getWeatherAll());  // The connection is in use
+  OWMPollState state;
+  while ((state = owm.poll()) == POLL_BUSY) {}
+  owm.setCallback(NULL);
+
+  // One failed location fails the whole, the others are still updated
+  EXPECT_EQ(state, POLL_FAILED);
+  std::vector<std::pair<int8_t, bool>> expected = {{0, true}, {1, false}, {2, true}};
+  EXPECT_EQ(finished, expected);
+  EXPECT_EQ(server.requests().size(), 3u);
+  for (uint8_t slot : {0, 2}) {
+    EXPECT_TRUE(owm.getLocation(slot)->updated);
+    ForecastOracle(response).expectForecast(owm.getLocation(slot)->forecast, 60, 48, 8);
+  }
+  EXPECT_FALSE(owm.getLocation(1)->updated);
+
+  // All updated
+  ASSERT_TRUE(owm.startWeatherAll());
+  while ((state = owm.poll()) == POLL_BUSY) {}
+  EXPECT_EQ(state, POLL_DONE);
+  EXPECT_TRUE(owm.getLocation(1)->updated);
+}
+
+TEST_P(Transport, PollMatchesGetWeather) {
+  ASSERT_TRUE(owm.getWeather());
+  std::vector<uint8_t> blocking = encoded(owm);
+
+  owm.setPollTime(2);
+  ASSERT_TRUE(owm.startWeather());
+  OWMPollState state;
+  int calls = 0;
+  while ((state = owm.poll()) == POLL_BUSY) calls++;
+  EXPECT_EQ(state, POLL_DONE);
+  EXPECT_GT(calls, 1);
+  EXPECT_EQ(encoded(owm), blocking);
+  EXPECT_EQ(server.connections(), 1);
+}
+
+TEST_P(Transport, PollDoesNotWaitForTheServer) {
+  if (std::get<0>(GetParam()) != CLIENT) GTEST_SKIP() << "HTTPClient waits for the headers";
+  MockResponse slow;
+  slow.body = response;
+  slow.delayMs = 300;
+  server.respond(slow);
+
+  ASSERT_TRUE(owm.startWeather());
+  OWMPollState state;
+  unsigned long longest = 0;
+  do {
+    unsigned long start = millis();
+    state = owm.poll();
+    longest = std::max(longest, millis() - start);
+  } while (state == POLL_BUSY);
+  EXPECT_EQ(state, POLL_DONE);
+  EXPECT_LT(longest, 100u);
+  EXPECT_GE(owm.getStats().firstByteMs, 300u);
+  ForecastOracle(response).expectForecast(owm, 60, 48, 8);
+}
+
+INSTANTIATE_TEST_SUITE_P(Modes, Transport,
+                         ::testing::Combine(::testing::Values(HTTP_CLIENT, CLIENT), ::testing::Bool()),
+                         [](const ::testing::TestParamInfo<std::tuple<TransportKind, bool>> &info) {
+                           return std::string(std::get<0>(info.param) == CLIENT ? "Client" : "HttpClient") +
+                                  (std::get<1>(info.param) ? "Streaming" : "Document");
+                         });
+
+}  // namespace